@@ -1,4 +1,6 @@
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 #include "Bitwise.h"
 #include "factory.h"
@@ -6,8 +8,8 @@
 using namespace IoAdapter;
 using namespace io;
 
-// Get the device instance using the Factory class
-const auto Device = Factory::getFt232H();
+// Get the device instance using the Factory class (opened directly, this runs before main())
+const auto Device = Factory::getFt232H(FT232_MPSSE::ChannelSelector::byIndex(0), FT232_MPSSE::OpenMode::Fast);
 
 // Get the IO handler instance from the Factory class using the device instance obtained earlier
 auto IoHandler = Factory::getIoHandler(Device);
@@ -89,6 +91,19 @@ int main()
 {
 
     IoHandler->valueChanged.connect([&](auto state) { callback(state); });
+
+    // Sample the inputs every 1 ms while the button is used and back off to 50 ms while idle
+    FT232_MPSSE::PollingConfig polling;
+    polling.mode = FT232_MPSSE::PollingConfig::Mode::Adaptive;
+    polling.period = std::chrono::milliseconds(1);
+    polling.idlePeriod = std::chrono::milliseconds(50);
+    Device->setPollingConfig(polling);
+
+    // Filter the button bounces: the pin has to stay 20 ms in its new state before it is notified
+    InputConditioner::PinConfig debounce;
+    debounce.debounce = InputConditioner::Debounce::Integrator;
+    debounce.window = std::chrono::milliseconds(20);
+    Device->inputConditioner().configure(inputPin, debounce);
     
     // Set pin D7 as input mode & C0 to output mode
     IoHandler->pinMode(inputPin, inOut::PinMode::Input);
@@ -105,12 +120,12 @@ int main()
         {
             //std::cout << "State: C0 High" << std::endl;
         }
-        Sleep(1000);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
         if(IoHandler->set(outputPin, inOut::GpioState::Low))
         {
            //std::cout << "State: C0 Low" << std::endl;
         }
-        Sleep(1000);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 
     pwmThread.join();
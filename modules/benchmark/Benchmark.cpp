@@ -0,0 +1,124 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+using namespace Benchmark;
+
+// Latency of the given percentile, the samples are sorted
+static std::chrono::nanoseconds percentile(const std::vector<std::chrono::nanoseconds>& samples, const double rank)
+{
+    if (samples.empty())
+        return std::chrono::nanoseconds(0);
+
+    const auto index = static_cast<size_t>(rank * static_cast<double>(samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+Runner::Runner(std::shared_ptr<IoAdapter::SimulatedFt232Transport> transport):
+    _transport(std::move(transport))
+{
+}
+
+Result Runner::run(const std::string& name, const uint64_t iterations, const double transfersBudget,
+                   const std::function<bool()>& operation)
+{
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.transfersBudget = transfersBudget;
+
+    // Warm up (caches, lazy initializations)
+    for (uint64_t iteration = 0; iteration < iterations / 10; ++iteration)
+    {
+        operation();
+    }
+
+    std::vector<std::chrono::nanoseconds> samples;
+    samples.reserve(iterations);
+
+    _transport->resetStatistics();
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t iteration = 0; iteration < iterations; ++iteration)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        if (!operation())
+        {
+            result.failures++;
+        }
+        samples.push_back(std::chrono::steady_clock::now() - begin);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto statistics = _transport->statistics();
+
+    std::sort(samples.begin(), samples.end());
+    const auto count = static_cast<double>(std::max<uint64_t>(iterations, 1));
+    result.opsPerSecond = count / std::max(std::chrono::duration<double>(elapsed).count(), 1e-9);
+    result.p50 = percentile(samples, 0.50);
+    result.p90 = percentile(samples, 0.90);
+    result.p99 = percentile(samples, 0.99);
+    result.max = samples.empty() ? std::chrono::nanoseconds(0) : samples.back();
+    result.transfersPerOp = static_cast<double>(statistics.usbTransfers) / count;
+    result.i2cPerOp = static_cast<double>(statistics.i2cTransactions) / count;
+    result.modeledPerOp = std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(statistics.elapsed.count()) / count));
+
+    _results.push_back(result);
+    return result;
+}
+
+bool Runner::report() const
+{
+    bool passed = true;
+
+    std::cout << std::left << std::setw(28) << "operation"
+              << std::right << std::setw(12) << "ops/sec"
+              << std::setw(10) << "p50 us"
+              << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us"
+              << std::setw(10) << "max us"
+              << std::setw(12) << "usb/op"
+              << std::setw(10) << "i2c/op"
+              << std::setw(14) << "modeled us/op"
+              << "  status" << std::endl;
+
+    for (const auto& result : _results)
+    {
+        // The simulator counts are exact, a small margin absorbs the transfers of the poll thread
+        const bool overBudget = result.transfersBudget >= 0 && result.transfersPerOp > result.transfersBudget * 1.01 + 0.001;
+        const bool failed = result.failures > 0 || overBudget;
+        passed = passed && !failed;
+
+        std::cout << std::left << std::setw(28) << result.name
+                  << std::right << std::fixed << std::setprecision(0) << std::setw(12) << result.opsPerSecond
+                  << std::setprecision(2)
+                  << std::setw(10) << result.p50.count() / 1000.0
+                  << std::setw(10) << result.p90.count() / 1000.0
+                  << std::setw(10) << result.p99.count() / 1000.0
+                  << std::setw(10) << result.max.count() / 1000.0
+                  << std::setw(12) << result.transfersPerOp
+                  << std::setw(10) << result.i2cPerOp
+                  << std::setw(14) << result.modeledPerOp.count() / 1000.0;
+
+        if (result.failures > 0)
+        {
+            std::cout << "  FAILED (" << result.failures << " errors)";
+        }
+        else if (overBudget)
+        {
+            std::cout << "  FAILED (budget " << result.transfersBudget << " usb/op)";
+        }
+        else
+        {
+            std::cout << "  ok";
+        }
+        std::cout << std::endl;
+    }
+    return passed;
+}
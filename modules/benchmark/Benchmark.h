@@ -0,0 +1,80 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Microbenchmark runner of the ioAdapter hot paths. Every operation runs against the simulated FT232H
+    so the results are reproducible without hardware:
+    - ops/sec and per-operation latency percentiles (host time, modeled USB delays included when slept),
+    - USB transfers and I2C transactions per operation (exact, counted by the simulator).
+
+    The transfers per operation don't depend on the host: a budget is set per operation and exceeding it
+    fails the run (regression gate).
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SimulatedFt232Transport.h"
+
+namespace Benchmark
+{
+    struct Result
+    {
+        std::string name;
+        uint64_t iterations = 0;
+        uint64_t failures = 0;                 // Operations returning an error
+        double opsPerSecond = 0;
+        std::chrono::nanoseconds p50{ 0 };
+        std::chrono::nanoseconds p90{ 0 };
+        std::chrono::nanoseconds p99{ 0 };
+        std::chrono::nanoseconds max{ 0 };
+        double transfersPerOp = 0;             // USB transfers
+        double i2cPerOp = 0;                   // I2C transactions
+        std::chrono::nanoseconds modeledPerOp{ 0 };// Modeled USB + bus time
+        double transfersBudget = -1;           // Negative: no budget
+    };
+
+    class Runner final
+    {
+    public:
+        explicit Runner(std::shared_ptr<IoAdapter::SimulatedFt232Transport> transport);
+        // Delete the default copy constructor
+        Runner(const Runner&) = delete;
+        Runner& operator=(const Runner&) = delete;
+        // Delete the default move constructor
+        Runner(Runner&&) = delete;
+        Runner& operator=(Runner&&) = delete;
+        ~Runner() = default;
+
+        /**
+         * @brief Measure an operation.
+         *
+         * @param name The operation name.
+         * @param iterations The number of measured operations (a tenth more are run first to warm up).
+         * @param transfersBudget The maximum USB transfers per operation, negative for none.
+         * @param operation The operation, returns false on error.
+         * @return The measures (also kept for report()).
+         */
+        Result run(const std::string& name, uint64_t iterations, double transfersBudget,
+                   const std::function<bool()>& operation);
+
+        /**
+         * @brief Print the measures as a table.
+         *
+         * @return True if every operation succeeded within its transfers budget.
+         */
+        bool report() const;
+
+    private:
+        std::shared_ptr<IoAdapter::SimulatedFt232Transport> _transport;
+        std::vector<Result> _results;
+    };
+}
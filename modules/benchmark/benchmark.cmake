@@ -0,0 +1,34 @@
+file(GLOB_RECURSE LIB_H
+    ${CMAKE_CURRENT_LIST_DIR}/*.h
+)
+
+file(GLOB_RECURSE LIB_CPP
+    ${CMAKE_CURRENT_LIST_DIR}/*.cpp
+)
+
+
+set(H_FILES ${LIB_H})
+
+set(CPP_FILES ${LIB_CPP})
+
+
+add_module(benchmark
+      MODULE_TYPE
+         exe
+      SOURCE_H_FILES
+         ${H_FILES}
+      SOURCE_CPP_FILES
+         ${CPP_FILES}
+      VS_FOLDER
+
+	  SAHRED_INCLUDES
+
+      DEPENDENCIES
+		ioAdapter
+	  POSTBUILD_COPY
+
+	  IMPORT_SUFFIX
+
+	  MODULE_HELP
+		FALSE
+)
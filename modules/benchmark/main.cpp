@@ -0,0 +1,301 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    ioAdapter microbenchmarks on the simulated FT232H.
+
+    Usage: benchmark [--iterations N] [--realtime] [--round-trip us] [--jitter us] [--seed N] [--trace file] [--probe]
+    - Without --realtime the modeled USB delays only advance the simulator clock (CPU cost of the code
+      paths, "modeled us/op" gives the time on a real adapter), with it they are slept.
+    - With --trace the transactions are recorded in a trace ring file (tracing overhead).
+    - With --probe the throughput of the PCA9685 at each bus speed and transfer mode is printed instead
+      (the delays are slept).
+    - The exit code is 1 when an operation fails or exceeds its USB transfers budget.
+
+    Build (Windows or Linux, no FTDI hardware or library needed):
+    cmake -S Cmakefile -B build && cmake --build build --target benchmark
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.h"
+#include "FT232_MPSSE.h"
+#include "I2CBusScheduler.h"
+#include "I2CThroughputProbe.h"
+#include "PCA9685.h"
+#include "PCA9685Array.h"
+#include "ServoMotion.h"
+#include "SimulatedFt232Transport.h"
+#include "TracingTransport.h"
+#include "ioHandler.h"
+
+using namespace IoAdapter;
+
+static constexpr uint8_t PwmDriverAddress = 0x40;
+static const std::vector<uint8_t> PwmArrayAddresses = { 0x41, 0x42, 0x43, 0x44 };
+
+int main(const int argc, char* argv[])
+{
+    uint64_t iterations = 10000;
+    std::string tracePath;
+    bool probe = false;
+    SimulatedFt232Transport::LatencyModel latency;
+    latency.realTime = false;
+
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        const std::string option = argv[arg];
+        const bool hasValue = arg + 1 < argc;
+        if (option == "--iterations" && hasValue)
+            iterations = std::strtoull(argv[++arg], nullptr, 10);
+        else if (option == "--realtime")
+            latency.realTime = true;
+        else if (option == "--round-trip" && hasValue)
+            latency.roundTrip = std::chrono::microseconds(std::strtoll(argv[++arg], nullptr, 10));
+        else if (option == "--jitter" && hasValue)
+            latency.jitter = std::chrono::microseconds(std::strtoll(argv[++arg], nullptr, 10));
+        else if (option == "--seed" && hasValue)
+            latency.seed = static_cast<uint32_t>(std::strtoul(argv[++arg], nullptr, 10));
+        else if (option == "--trace" && hasValue)
+            tracePath = argv[++arg];
+        else if (option == "--probe")
+            probe = true;
+        else
+        {
+            std::cerr << "Usage: benchmark [--iterations N] [--realtime] [--round-trip us] [--jitter us] [--seed N] [--trace file] [--probe]" << std::endl;
+            return 2;
+        }
+    }
+
+    // The probe measures the wall clock
+    if (probe)
+    {
+        latency.realTime = true;
+    }
+
+    const auto transport = std::make_shared<SimulatedFt232Transport>(latency);
+    transport->addI2CSlave(0, PwmDriverAddress);
+    for (const auto address : PwmArrayAddresses)
+    {
+        transport->addI2CSlave(0, address);
+    }
+    transport->addI2CGroup(0, ioAdapter::PCA9685Array::DefaultAllCallAddress, PwmArrayAddresses);
+
+    std::shared_ptr<Ft232Transport> deviceTransport = transport;
+    if (!tracePath.empty())
+    {
+        const auto ring = TraceRing::create(tracePath, 65536);
+        if (ring == nullptr)
+            return 1;
+        deviceTransport = std::make_shared<TracingTransport>(transport, ring);
+    }
+
+    const auto device = std::make_shared<FT232_MPSSE>(FT232_MPSSE::ChannelSelector::byIndex(0),
+                                                      FT232_MPSSE::OpenMode::Fast, deviceTransport);
+    if (!device->isOpen())
+    {
+        std::cerr << "The simulated FT232H can't be opened" << std::endl;
+        return 1;
+    }
+
+    // Keep the poll thread out of the measures
+    FT232_MPSSE::PollingConfig polling;
+    polling.period = std::chrono::seconds(1);
+    polling.idlePeriod = std::chrono::seconds(1);
+    device->setPollingConfig(polling);
+
+    if (probe)
+    {
+        I2CThroughputProbe::Config config;
+        config.address = PwmDriverAddress;
+        const auto results = I2CThroughputProbe::run(device, config);
+        I2CThroughputProbe::print(std::cout, results);
+        return I2CThroughputProbe::fastest(results) != nullptr ? 0 : 1;
+    }
+
+    const auto handler = std::make_shared<ioAdapter::ioHandler>(device);
+    const auto pwmDriver = std::make_shared<ioAdapter::PCA9685>(device, PwmDriverAddress);
+
+    handler->pinMode(io::inOut::Gpio::C0, io::inOut::PinMode::Output);
+    handler->pinMode(io::inOut::Gpio::C1, io::inOut::PinMode::Input);
+
+    Benchmark::Runner runner(transport);
+
+    bool level = false;
+    runner.run("ioHandler::set", iterations, 1, [&]()
+    {
+        level = !level;
+        return handler->set(io::inOut::Gpio::C0, level ? io::inOut::GpioState::High : io::inOut::GpioState::Low);
+    });
+
+    runner.run("ioHandler::get", iterations, 2, [&]()
+    {
+        io::inOut::GpioState state;
+        return handler->get(io::inOut::Gpio::C1, state);
+    });
+
+    runner.run("FT232_MPSSE::writeWord", iterations, 1, [&]()
+    {
+        return device->writeWord(PwmDriverAddress, 0x06, 0x0123) == 0;
+    });
+
+    runner.run("FT232_MPSSE::readWord", iterations, 2, [&]()
+    {
+        uint16_t value = 0;
+        return device->readWord(PwmDriverAddress, 0x06, value) == 0;
+    });
+
+    // One 16 bytes block (4 PWM channels) per transaction
+    uint8_t block[17] = { 0x06 };
+    runner.run("FT232_MPSSE::write 16B", iterations, 1, [&]()
+    {
+        return device->write(PwmDriverAddress, block, sizeof(block)) == sizeof(block);
+    });
+
+    runner.run("FT232_MPSSE::writeRead 16B", iterations, 2, [&]()
+    {
+        return device->writeRead(PwmDriverAddress, block, 1, block + 1, 16) == 16;
+    });
+
+    // Same write through the bus scheduler: cost of the hand over to the bus owner thread
+    const auto scheduler = I2CBusScheduler::create(device);
+    const auto realTimeMaster = scheduler->client(I2CBusScheduler::Priority::RealTime);
+    runner.run("I2CBusScheduler write 16B", iterations, 1, [&]()
+    {
+        return realTimeMaster->write(PwmDriverAddress, block, 17) == 17;
+    });
+
+    double dutyCycle = 0;
+    runner.run("PCA9685::firePwm", iterations, 1, [&]()
+    {
+        dutyCycle = dutyCycle >= 100 ? 0 : dutyCycle + 0.5;
+        pwmDriver->firePwm(0, dutyCycle);
+        return true;
+    });
+
+    // Integer path: compile time channel handle, 12 bits counts
+    constexpr auto servo = ioAdapter::PCA9685::channel<0>();
+    uint16_t counts = 0;
+    runner.run("PCA9685::setDutyCounts", iterations, 1, [&]()
+    {
+        counts = static_cast<uint16_t>((counts + 20) % 4096);
+        return pwmDriver->setDutyCounts(servo, counts);
+    });
+
+    uint32_t pulseWidth = 1000;
+    runner.run("PCA9685::setPulseWidth", iterations, 1, [&]()
+    {
+        pulseWidth = pulseWidth >= 2000 ? 1000 : pulseWidth + 10;
+        return pwmDriver->setPulseWidth(servo, pulseWidth);
+    });
+
+    ioAdapter::PCA9685::Frame frame;
+    runner.run("PCA9685::writeFrame", iterations, 1, [&]()
+    {
+        dutyCycle = dutyCycle >= 100 ? 0 : dutyCycle + 0.5;
+        frame.fill(ioAdapter::PCA9685::dutyCycleSetting(dutyCycle));
+        return pwmDriver->writeFrame(frame);
+    });
+
+    runner.run("PCA9685::setAll", iterations, 1, [&]()
+    {
+        dutyCycle = dutyCycle >= 100 ? 0 : dutyCycle + 0.5;
+        return pwmDriver->setAll(ioAdapter::PCA9685::dutyCycleSetting(dutyCycle));
+    });
+
+    // The shadow registers skip the unchanged values
+    runner.run("PCA9685::firePwm unchanged", iterations, 0, [&]()
+    {
+        pwmDriver->firePwm(0, 50);
+        return true;
+    });
+
+    unsigned frequency = 50;
+    runner.run("PCA9685::setPwmFrequency", iterations, 3, [&]()
+    {
+        frequency = frequency == 50 ? 60 : 50;
+        pwmDriver->setPwmFrequency(frequency);
+        return true;
+    });
+
+    runner.run("setPwmFrequency unchanged", iterations, 0, [&]()
+    {
+        pwmDriver->setPwmFrequency(frequency);
+        return true;
+    });
+
+    // 16 servos moving together: one burst per update, nothing sent once they stopped
+    ioAdapter::ServoMotion motion(pwmDriver);
+    std::vector<ioAdapter::ServoMotion::Target> targets;
+    for (unsigned channel = 0; channel < ioAdapter::PCA9685::ChannelsCount; ++channel)
+    {
+        ioAdapter::ServoMotion::ServoConfig config;
+        config.channel = channel;
+        targets.push_back({ motion.addServo(config), 0 });
+    }
+    double angle = 90;
+    runner.run("ServoMotion::tick 16 servos", iterations, 1, [&]()
+    {
+        if (motion.idle())
+        {
+            angle = -angle;
+            for (auto& target : targets)
+                target.angle = angle;
+            motion.moveSynchronized(targets);
+        }
+        return motion.tick();
+    });
+
+    // 4 chips: shared settings in one All Call write, per channel settings in one burst per chip
+    ioAdapter::PCA9685Array pwmArray(device, PwmArrayAddresses);
+    pwmArray.begin();
+    runner.run("PCA9685Array::setAll 4 chips", iterations, 1, [&]()
+    {
+        counts = static_cast<uint16_t>((counts + 20) % 4096);
+        return pwmArray.setAll(ioAdapter::PCA9685Array::Group::AllCall, ioAdapter::PCA9685::dutyCountsSetting(counts));
+    });
+
+    std::vector<size_t> arrayChannels(pwmArray.channelsCount());
+    std::vector<ioAdapter::PCA9685::PwmSetting> arraySettings(pwmArray.channelsCount());
+    for (size_t channel = 0; channel < arrayChannels.size(); ++channel)
+    {
+        arrayChannels[channel] = channel;
+    }
+    runner.run("PCA9685Array::setPwm 64 ch", iterations, 4, [&]()
+    {
+        counts = static_cast<uint16_t>((counts + 20) % 4096);
+        for (auto& setting : arraySettings)
+        {
+            setting = ioAdapter::PCA9685::dutyCountsSetting(counts);
+        }
+        return pwmArray.setPwm(arrayChannels.data(), arraySettings.data(), arrayChannels.size());
+    });
+
+    const bool passed = runner.report();
+
+    // Adapter side view of the same run
+    const auto metrics = device->metrics();
+    const std::pair<const char*, const OperationSnapshot*> operations[] = {
+        { "FT_Write", &metrics.write },
+        { "FT_Read", &metrics.read },
+        { "I2C_DeviceWrite", &metrics.deviceWrite },
+        { "I2C_DeviceRead", &metrics.deviceRead }
+    };
+    std::cout << std::endl;
+    for (const auto& [name, operation] : operations)
+    {
+        std::cout << name << ": " << operation->calls << " calls, " << operation->errors << " errors, "
+                  << operation->bytes << " bytes, p50 " << operation->latency.percentile(0.50).count() / 1000.0
+                  << " us, p99 " << operation->latency.percentile(0.99).count() / 1000.0 << " us" << std::endl;
+    }
+    std::cout << "poll iterations: " << metrics.pollIterations << ", retries: " << metrics.retries
+              << ", reconnects: " << metrics.reconnects << std::endl;
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+#include "devicePool.h"
+
+DevicePool::DevicePool(const Filter& filter)
+{
+    for (const auto& channel : IoAdapter::FT232_MPSSE::enumerate())
+    {
+        if (channel.opened || (filter && !filter(channel)))
+            continue;
+
+        // Open by location: stable and unique even for the channels of the same multi-channel chip.
+        // The channel is already known, no enumeration per device
+        auto device = std::make_shared<IoAdapter::FT232_MPSSE>(
+            IoAdapter::FT232_MPSSE::ChannelSelector::byLocation(channel.locationId),
+            IoAdapter::FT232_MPSSE::OpenMode::Fast);
+        if (device->isOpen())
+        {
+            _devices.push_back(std::move(device));
+        }
+    }
+}
+
+DevicePool::~DevicePool()
+{
+    _devices.clear();
+}
+
+std::shared_ptr<IoAdapter::FT232_MPSSE> DevicePool::find(const std::string& serialNumber) const
+{
+    for (const auto& device : _devices)
+    {
+        if (device->channel().serialNumber == serialNumber)
+            return device;
+    }
+    return nullptr;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "export.h"
+
+#include "FT232_MPSSE.h"
+
+/**
+ * @brief Set of MPSSE adapters opened together (FT232H, FT2232H & FT4232H channels).
+ *
+ * Every adapter keeps its own poll, dispatcher and I/O owner threads, so the I/O of the adapters run in
+ * parallel, one USB channel each.
+ */
+class FACTORY_API DevicePool final
+{
+    public:
+        using Filter = std::function<bool(const IoAdapter::FT232_MPSSE::ChannelInfo&)>;
+
+        /**
+         * @brief Open all the channels accepted by the filter and not already opened.
+         *
+         * @param filter Channels filter (all the channels if empty).
+         */
+        explicit DevicePool(const Filter& filter = Filter());
+        // Delete the default copy constructor
+        DevicePool(const DevicePool&) = delete;
+        DevicePool& operator=(const DevicePool&) = delete;
+        // Delete the default move constructor
+        DevicePool(DevicePool&&) = delete;
+        DevicePool& operator=(DevicePool&&) = delete;
+        ~DevicePool();
+
+        size_t size() const { return _devices.size(); }
+
+        std::shared_ptr<IoAdapter::FT232_MPSSE> at(size_t index) const { return _devices.at(index); }
+
+        /**
+         * @brief Find an adapter by the serial number of its channel.
+         *
+         * @param serialNumber The channel serial number.
+         * @return The adapter or nullptr if not found.
+         */
+        std::shared_ptr<IoAdapter::FT232_MPSSE> find(const std::string& serialNumber) const;
+
+        const std::vector<std::shared_ptr<IoAdapter::FT232_MPSSE>>& devices() const { return _devices; }
+
+    private:
+        std::vector<std::shared_ptr<IoAdapter::FT232_MPSSE>> _devices;
+};
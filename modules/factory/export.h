@@ -1,7 +1,11 @@
 #pragma once
 
+#ifdef _WIN32
 #ifdef FACTORY_EXPORTS
 #define FACTORY_API __declspec(dllexport)
 #else
 #define FACTORY_API __declspec(dllimport)
+#endif
+#else
+#define FACTORY_API __attribute__((visibility("default")))
 #endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <memory>
 
+#include "TracingTransport.h"
+
 Factory::Factory()
 {
     
@@ -17,6 +19,40 @@ std::shared_ptr<IoAdapter::FT232_MPSSE> Factory::getFt232H()
     return std::make_shared<IoAdapter::FT232_MPSSE>();
 }
 
+std::shared_ptr<IoAdapter::FT232_MPSSE> Factory::getFt232H(const IoAdapter::FT232_MPSSE::ChannelSelector& selector)
+{
+    return std::make_shared<IoAdapter::FT232_MPSSE>(selector);
+}
+
+std::shared_ptr<IoAdapter::FT232_MPSSE> Factory::getFt232H(const IoAdapter::FT232_MPSSE::ChannelSelector& selector,
+                                                            const IoAdapter::FT232_MPSSE::OpenMode mode)
+{
+    return std::make_shared<IoAdapter::FT232_MPSSE>(selector, mode);
+}
+
+std::shared_ptr<IoAdapter::FT232_MPSSE> Factory::getTracedFt232H(const IoAdapter::FT232_MPSSE::ChannelSelector& selector,
+                                                                  const IoAdapter::FT232_MPSSE::OpenMode mode,
+                                                                  const std::string& tracePath,
+                                                                  const uint64_t records)
+{
+    std::shared_ptr<IoAdapter::Ft232Transport> transport = IoAdapter::FT232_MPSSE::defaultTransport();
+    if (const auto ring = IoAdapter::TraceRing::create(tracePath, records))
+    {
+        transport = std::make_shared<IoAdapter::TracingTransport>(transport, ring);
+    }
+    return std::make_shared<IoAdapter::FT232_MPSSE>(selector, mode, transport);
+}
+
+std::vector<IoAdapter::FT232_MPSSE::ChannelInfo> Factory::getFt232HChannels()
+{
+    return IoAdapter::FT232_MPSSE::enumerate();
+}
+
+std::shared_ptr<DevicePool> Factory::getDevicePool(const DevicePool::Filter& filter)
+{
+    return std::make_shared<DevicePool>(filter);
+}
+
 std::shared_ptr<ioAdapter::ioHandler> Factory::getIoHandler(const std::shared_ptr<io::inOut>& device)
 {
     return std::make_shared<ioAdapter::ioHandler>(device);
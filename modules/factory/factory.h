@@ -3,6 +3,7 @@
 
 #include "export.h"
 
+#include "devicePool.h"
 #include "FT232_MPSSE.h"
 #include "PCA9685.h"
 #include "ioHandler.h"
@@ -21,6 +22,29 @@ class  FACTORY_API Factory final
 
         static std::shared_ptr<IoAdapter::FT232_MPSSE> getFt232H();
 
+        static std::shared_ptr<IoAdapter::FT232_MPSSE> getFt232H(const IoAdapter::FT232_MPSSE::ChannelSelector& selector);
+
+        static std::shared_ptr<IoAdapter::FT232_MPSSE> getFt232H(const IoAdapter::FT232_MPSSE::ChannelSelector& selector,
+                                                                 IoAdapter::FT232_MPSSE::OpenMode mode);
+
+        /**
+         * @brief Get an FT232H whose USB & I2C transactions are recorded in a trace ring file (see traceDecoder).
+         *
+         * @param selector The opened channel.
+         * @param mode The open mode.
+         * @param tracePath The ring file, created or truncated.
+         * @param records The ring capacity (128 bytes per record).
+         * @return The adapter, not traced if the ring file can't be created.
+         */
+        static std::shared_ptr<IoAdapter::FT232_MPSSE> getTracedFt232H(const IoAdapter::FT232_MPSSE::ChannelSelector& selector,
+                                                                       IoAdapter::FT232_MPSSE::OpenMode mode,
+                                                                       const std::string& tracePath,
+                                                                       uint64_t records = 65536);
+
+        static std::vector<IoAdapter::FT232_MPSSE::ChannelInfo> getFt232HChannels();
+
+        static std::shared_ptr<DevicePool> getDevicePool(const DevicePool::Filter& filter = DevicePool::Filter());
+
         static std::shared_ptr<ioAdapter::ioHandler> getIoHandler(const std::shared_ptr<io::inOut>& device);
 
         static std::shared_ptr<ioAdapter::PCA9685> getPwmDriver(const std::shared_ptr<I2C::I2CMaster>& device);
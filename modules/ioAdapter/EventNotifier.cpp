@@ -0,0 +1,87 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "EventNotifier.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+using namespace IoAdapter;
+
+#ifdef _WIN32
+
+EventNotifier::EventNotifier() :
+    _handle(CreateEventW(nullptr, TRUE, FALSE, nullptr))
+{
+    if (_handle == nullptr)
+    {
+        throw std::runtime_error("Failed to create the event notifier");
+    }
+}
+
+EventNotifier::~EventNotifier()
+{
+    CloseHandle(_handle);
+}
+
+void EventNotifier::notify()
+{
+    SetEvent(_handle);
+}
+
+void EventNotifier::acknowledge()
+{
+    ResetEvent(_handle);
+}
+
+bool EventNotifier::wait(const std::chrono::milliseconds timeout)
+{
+    return WaitForSingleObject(_handle, static_cast<DWORD>(timeout.count())) == WAIT_OBJECT_0;
+}
+
+#else
+
+EventNotifier::EventNotifier() :
+    _handle(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (_handle < 0)
+    {
+        throw std::runtime_error("Failed to create the event notifier");
+    }
+}
+
+EventNotifier::~EventNotifier()
+{
+    close(_handle);
+}
+
+void EventNotifier::notify()
+{
+    constexpr uint64_t increment = 1;
+    (void)::write(_handle, &increment, sizeof(increment));
+}
+
+void EventNotifier::acknowledge()
+{
+    uint64_t counter = 0;
+    (void)::read(_handle, &counter, sizeof(counter));
+}
+
+bool EventNotifier::wait(const std::chrono::milliseconds timeout)
+{
+    pollfd descriptor{ _handle, POLLIN, 0 };
+    return ::poll(&descriptor, 1, static_cast<int>(timeout.count())) > 0;
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Waitable notification handle (eventfd on Linux, manual-reset event on Windows) set by a producer and
+    waited by a consumer, either with wait() or through its native handle in the consumer own event loop.
+*/
+
+#pragma once
+
+#include <chrono>
+
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API EventNotifier final
+    {
+    public:
+#ifdef _WIN32
+        using NativeHandle = void*;// HANDLE
+#else
+        using NativeHandle = int;  // File descriptor
+#endif
+
+        EventNotifier();
+        // Delete the default copy constructor
+        EventNotifier(const EventNotifier&) = delete;
+        EventNotifier& operator=(const EventNotifier&) = delete;
+        // Delete the default move constructor
+        EventNotifier(EventNotifier&&) = delete;
+        EventNotifier& operator=(EventNotifier&&) = delete;
+        ~EventNotifier();
+
+        /**
+         * @brief Signal the notification (producer side).
+         */
+        void notify();
+
+        /**
+         * @brief Clear the notification (consumer side).
+         */
+        void acknowledge();
+
+        /**
+         * @brief Wait until the notification is signaled.
+         *
+         * @param timeout The maximum time to wait.
+         * @return True if the notification is signaled, false on timeout.
+         */
+        bool wait(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Get the native handle, readable (signaled) while a notification is pending.
+         *
+         * @return The eventfd file descriptor (Linux) or the event HANDLE (Windows).
+         */
+        NativeHandle nativeHandle() const { return _handle; }
+
+    private:
+        NativeHandle _handle;
+    };
+}
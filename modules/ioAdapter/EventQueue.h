@@ -0,0 +1,220 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Bounded lock-free multi-producer queue (D. Vyukov per-slot sequence algorithm) used to hand the input
+    events of the poll thread over to their consumers without blocking the sampling.
+    - DropNewest: a push on a full queue is rejected.
+    - OverwriteOldest: a push on a full queue discards the oldest queued event.
+    Every successful push signals the queue notifier, its native handle (eventfd on Linux, event HANDLE on
+    Windows) can be added to the consumer event loop (epoll, WaitForMultipleObjects...).
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "EventNotifier.h"
+
+namespace IoAdapter
+{
+    template <typename T, size_t Capacity>
+    class EventQueue final
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+    public:
+        enum class OverflowPolicy
+        {
+            DropNewest,
+            OverwriteOldest
+        };
+
+        struct Counters
+        {
+            uint64_t pushed = 0;
+            uint64_t popped = 0;
+            uint64_t dropped = 0;    // Rejected pushes (DropNewest)
+            uint64_t overwritten = 0;// Discarded oldest events (OverwriteOldest)
+        };
+
+        explicit EventQueue(const OverflowPolicy policy = OverflowPolicy::OverwriteOldest) :
+            _policy(policy)
+        {
+            for (size_t index = 0; index < Capacity; ++index)
+            {
+                _slots[index].sequence.store(index, std::memory_order_relaxed);
+            }
+        }
+        // Delete the default copy constructor
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+        // Delete the default move constructor
+        EventQueue(EventQueue&&) = delete;
+        EventQueue& operator=(EventQueue&&) = delete;
+        ~EventQueue() = default;
+
+        /**
+         * @brief Queue an event and signal the notifier (producer side, never blocks).
+         *
+         * @param value The event.
+         * @return True if the event was queued, false if it was dropped.
+         */
+        bool push(const T& value)
+        {
+            while (!tryPush(value))
+            {
+                if (_policy.load(std::memory_order_relaxed) == OverflowPolicy::DropNewest)
+                {
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                // Make room by discarding the oldest event
+                T discarded;
+                if (tryPop(discarded))
+                {
+                    _overwritten.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            _pushed.fetch_add(1, std::memory_order_relaxed);
+            _notifier.notify();
+            return true;
+        }
+
+        /**
+         * @brief Dequeue the oldest event (consumer side, never blocks).
+         *
+         * @param value Reference to store the event.
+         * @return True if an event was dequeued, false if the queue is empty.
+         */
+        bool pop(T& value)
+        {
+            if (!tryPop(value))
+                return false;
+
+            _popped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief Clear the notification then dequeue all the available events.
+         *
+         * @param consumer Callable invoked for each event.
+         * @return The number of dequeued events.
+         */
+        template <typename Consumer>
+        size_t consume(Consumer&& consumer)
+        {
+            // Events pushed after the acknowledge signal the notifier again
+            _notifier.acknowledge();
+
+            size_t count = 0;
+            T value;
+            while (pop(value))
+            {
+                consumer(value);
+                ++count;
+            }
+            return count;
+        }
+
+        void setOverflowPolicy(const OverflowPolicy policy) { _policy.store(policy, std::memory_order_relaxed); }
+        OverflowPolicy overflowPolicy() const { return _policy.load(std::memory_order_relaxed); }
+
+        Counters counters() const
+        {
+            Counters counters;
+            counters.pushed = _pushed.load(std::memory_order_relaxed);
+            counters.popped = _popped.load(std::memory_order_relaxed);
+            counters.dropped = _dropped.load(std::memory_order_relaxed);
+            counters.overwritten = _overwritten.load(std::memory_order_relaxed);
+            return counters;
+        }
+
+        EventNotifier& notifier() { return _notifier; }
+
+        static constexpr size_t capacity() { return Capacity; }
+
+    private:
+        bool tryPush(const T& value)
+        {
+            Slot* slot;
+            size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+            while (true)
+            {
+                slot = &_slots[position & (Capacity - 1)];
+                const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0)
+                {
+                    if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (difference < 0)
+                {
+                    return false;// Full
+                }
+                else
+                {
+                    position = _enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->value = value;
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool tryPop(T& value)
+        {
+            Slot* slot;
+            size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+            while (true)
+            {
+                slot = &_slots[position & (Capacity - 1)];
+                const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+                if (difference == 0)
+                {
+                    if (_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (difference < 0)
+                {
+                    return false;// Empty
+                }
+                else
+                {
+                    position = _dequeuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            value = slot->value;
+            slot->sequence.store(position + Capacity, std::memory_order_release);
+            return true;
+        }
+
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::array<Slot, Capacity> _slots;
+        alignas(64) std::atomic<size_t> _enqueuePosition{ 0 };
+        alignas(64) std::atomic<size_t> _dequeuePosition{ 0 };
+        alignas(64) std::atomic<OverflowPolicy> _policy;
+        std::atomic<uint64_t> _pushed{ 0 };
+        std::atomic<uint64_t> _popped{ 0 };
+        std::atomic<uint64_t> _dropped{ 0 };
+        std::atomic<uint64_t> _overwritten{ 0 };
+        EventNotifier _notifier;
+    };
+}
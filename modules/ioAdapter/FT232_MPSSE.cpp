@@ -14,11 +14,17 @@
 */
 
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
 
 #include "FT232_MPSSE.h"
+#ifdef IO_ADAPTER_FTDI
+#include "FtdiTransport.h"
+#else
+#include "SimulatedFt232Transport.h"
+#endif
 
-#include "libmpsse_i2c.h"
 #include "Bitwise.h"
 
 
@@ -83,71 +89,259 @@ constexpr GpioValue FinalVal = GpioValue::Low;
 
 
 
-enum class MpsseCommand : uint8_t {
-    SetDataBitsLowbyte = 0x80,
-    SetDataBitsHighbyte = 0x82,
-    GetDataBitsLowbyte = 0x81,
-    GetDataBitsHighbyte	= 0x83,
-    SendImmediate	= 0x87
-};
-
 #define I2C_WRITE_COMPLETION_RETRY 10
 
 using namespace IoAdapter;
 
+// Map an I2C speed on the libMPSSE clock rates, false if the speed isn't supported
+static bool clockRateOf(const I2C::I2CMaster::Speed speed, uint32_t& clockRate)
+{
+    switch (speed)
+    {
+    case I2C::I2CMaster::Speed::_10kbs:
+        return false;
+    case I2C::I2CMaster::Speed::_100kbs:
+        clockRate = Ft232Transport::ClockStandardMode;
+        break;
+    case I2C::I2CMaster::Speed::_200kbs:
+        return false;
+    case I2C::I2CMaster::Speed::_400kbs:
+        clockRate = Ft232Transport::ClockFastMode;
+        break;
+    case I2C::I2CMaster::Speed::_1mbs:
+        clockRate = Ft232Transport::ClockFastModePlus;
+        break;
+    case I2C::I2CMaster::Speed::_17mbs:
+        return false;
+    case I2C::I2CMaster::Speed::_34mbs:
+        clockRate = Ft232Transport::ClockHighSpeedMode;
+        break;
+    }
+
+    return true;
+}
+
+FT232_MPSSE::ChannelSelector FT232_MPSSE::ChannelSelector::byIndex(const uint32_t index)
+{
+    ChannelSelector selector;
+    selector.by = By::Index;
+    selector.index = index;
+    return selector;
+}
+
+FT232_MPSSE::ChannelSelector FT232_MPSSE::ChannelSelector::bySerialNumber(const std::string& serialNumber)
+{
+    ChannelSelector selector;
+    selector.by = By::SerialNumber;
+    selector.value = serialNumber;
+    return selector;
+}
+
+FT232_MPSSE::ChannelSelector FT232_MPSSE::ChannelSelector::byDescription(const std::string& description)
+{
+    ChannelSelector selector;
+    selector.by = By::Description;
+    selector.value = description;
+    return selector;
+}
+
+FT232_MPSSE::ChannelSelector FT232_MPSSE::ChannelSelector::byLocation(const uint32_t locationId)
+{
+    ChannelSelector selector;
+    selector.by = By::Location;
+    selector.locationId = locationId;
+    return selector;
+}
+
+bool FT232_MPSSE::ChannelSelector::matches(const ChannelInfo& channel) const
+{
+    switch (by)
+    {
+    case By::Index:
+        return channel.index == index;
+    case By::SerialNumber:
+        return channel.serialNumber == value;
+    case By::Description:
+        return channel.description == value;
+    case By::Location:
+        return channel.locationId == locationId;
+    }
+    return false;
+}
+
+std::shared_ptr<Ft232Transport> FT232_MPSSE::defaultTransport()
+{
+#ifdef IO_ADAPTER_FTDI
+    return std::make_shared<FtdiTransport>();
+#else
+    // No libftd2xx in this build
+    return std::make_shared<SimulatedFt232Transport>();
+#endif
+}
+
+std::vector<FT232_MPSSE::ChannelInfo> FT232_MPSSE::enumerate()
+{
+    return enumerate(*defaultTransport());
+}
+
+std::vector<FT232_MPSSE::ChannelInfo> FT232_MPSSE::enumerate(Ft232Transport& transport)
+{
+    std::vector<ChannelInfo> channels;
+
+    transport.acquire();
+
+    uint32_t channelsCount = 0;
+    if (transport.getNumChannels(channelsCount) == Ft232Transport::Ok)
+    {
+        for (uint32_t channel = 0; channel < channelsCount; channel++)
+        {
+            Ft232Transport::DeviceInfo devList;
+            if (transport.getChannelInfo(channel, devList) != Ft232Transport::Ok)
+                continue;
+
+            ChannelInfo info;
+            info.index = channel;
+            info.flags = devList.flags;
+            info.type = devList.type;
+            info.id = devList.id;
+            info.locationId = devList.locationId;
+            info.serialNumber = devList.serialNumber;
+            info.description = devList.description;
+            info.opened = (devList.flags & 0x01) != 0;// FT_FLAGS_OPENED
+            channels.push_back(info);
+        }
+    }
+
+    transport.release();
+    return channels;
+}
+
+FT232_MPSSE::ChannelInfo FT232_MPSSE::channel() const
+{
+    const std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _channel;
+}
+
+std::chrono::microseconds FT232_MPSSE::startupTime() const
+{
+    const std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _startupTime;
+}
+
+FT232_MPSSE::MetricsSnapshot FT232_MPSSE::metrics() const
+{
+    MetricsSnapshot snapshot;
+    snapshot.write = _writeMetrics.snapshot();
+    snapshot.read = _readMetrics.snapshot();
+    snapshot.deviceWrite = _deviceWriteMetrics.snapshot();
+    snapshot.deviceRead = _deviceReadMetrics.snapshot();
+    snapshot.retries = _retries.load(std::memory_order_relaxed);
+    snapshot.reconnects = _reconnects.load(std::memory_order_relaxed);
+    snapshot.pollIterations = _pollIterations.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
 FT232_MPSSE::FT232_MPSSE():
+    FT232_MPSSE(ChannelSelector())
+{
+}
+
+FT232_MPSSE::FT232_MPSSE(const ChannelSelector& selector):
+    FT232_MPSSE(selector, OpenMode::Enumerate)
+{
+}
+
+FT232_MPSSE::FT232_MPSSE(const ChannelSelector& selector, const OpenMode mode):
+    FT232_MPSSE(selector, mode, defaultTransport())
+{
+}
+
+FT232_MPSSE::FT232_MPSSE(const ChannelSelector& selector, const OpenMode mode, std::shared_ptr<Ft232Transport> transport):
+    _transport(std::move(transport)),
     _handle(nullptr),
-    _thread(boost::thread(&FT232_MPSSE::doWork, this)),
-    _previousPinsState(0)
+    _selector(selector),
+    _openMode(mode),
+    _created(std::chrono::steady_clock::now()),
+    _previousPinsState(0),
+    _executor([this]() { beginBatch(); }, [this]() { return endBatch(); })
 {
+    // The first opening is done before the poll thread starts (it only retries a failed one)
+    _transport->acquire();
     init();
+
+    _thread = boost::thread(&FT232_MPSSE::doWork, this);
+    _dispatcher = boost::thread(&FT232_MPSSE::dispatchEvents, this);
 }
 
 FT232_MPSSE::~FT232_MPSSE()
 {
+    _executor.stop();
+    _thread.interrupt();
+    _dispatcher.interrupt();
+    _thread.join();
+    _dispatcher.join();
+
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
     clearAllPins();
-    Cleanup_libMPSSE();
     closeHandle();
+    _transport->release();
 }
 
-bool FT232_MPSSE::pinMode(const Gpio gpio, const PinMode mode)
+// Port of a GPIO pin and its bit inside the port byte
+static io::inOut::Port portOf(const io::inOut::Gpio gpio)
 {
-    // Exclusive lock for write access
-    const std::unique_lock<std::shared_mutex> lock(_mutex);
-    //const std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return static_cast<int>(gpio) > 7 ? io::inOut::Port::C : io::inOut::Port::D;
+}
 
-    if (_handle == nullptr)
+static int portBit(const io::inOut::Gpio gpio)
+{
+    return static_cast<int>(gpio) % 8;
+}
+
+static int portOffset(const io::inOut::Port port)
+{
+    return port == io::inOut::Port::C ? 8 : 0;
+}
+
+bool FT232_MPSSE::pinMode(const Gpio gpio, const PinMode mode)
+{
+    //C8 & C9 are not controllable as GPIO pins in MPSSE mode
+    if (static_cast<int>(gpio) > static_cast<int>(Gpio::C7))
         return false;
 
-    if (_pinsMode.at(gpio) == PinMode::Sf)
+    return pinsMode(portOf(gpio), static_cast<uint8_t>(Bitwise::shift(portBit(gpio))), mode);
+}
+
+bool FT232_MPSSE::pinsMode(const Port port, const uint8_t mask, const PinMode mode)
+{
+    if (_handle == nullptr)
         return false;
 
-    // Read current configuration
-    uint32_t currentMask = 0xFFFFFFFF;
-    for (const auto& [pinNumber, pinMode] : _pinsMode)
+    if (mode == PinMode::Sf)
     {
-        if (pinMode == PinMode::Output)
-        {
-            Bitwise::setBit(currentMask, static_cast<int>(pinNumber));
-        }
-        else
-        {
-            Bitwise::clearBit(currentMask, static_cast<int>(pinNumber));
-        }
+        std::cerr << "Special function mode can't be selected as a GPIO pin mode" << std::endl;
+        return false;
     }
 
-    if (static_cast<int>(gpio) > 7)
-    {
-        //select C0:C7 (Most significant bit)
-        _dir = currentMask >> 8 & 0xFF;//ex: b00001001 01000000 --> selection >> 8 & 0xFF : b01000000
-    }
-    else
+    // Exclusive lock for write access, the pins are checked against the state that is written
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+    const uint16_t pins = static_cast<uint16_t>(mask << portOffset(port));
+    if (pins & _specialFunctions.load())
     {
-        //select D0:D7 (Low significant bit)
-        _dir = currentMask & 0xF0;//ex: b00001001 01000000 --> selection & 0xF0 : b00001001 & maintain the first 4 bits to 0 because there has a special functions with i2c ( clck, data...)
+        std::cerr << "Port pins 0x" << std::hex << static_cast<int>(mask) << std::dec << " are reserved for a special function" << std::endl;
+        return false;
     }
 
-    _pinsMode.at(gpio) = mode;
+    const uint16_t currentDirections = _directions.load();
+    const uint16_t directions = mode == PinMode::Output ? currentDirections | pins
+                                                        : currentDirections & ~pins;
+
+    // One MPSSE command applies the new direction of every pin of the port
+    if (!writePortCommand(port, _values.load(), directions))
+        return false;
+
+    _directions.store(directions);
     return true;
 }
 
@@ -164,192 +358,523 @@ bool FT232_MPSSE::pinMode(const Gpio gpio, const PinMode mode)
  
  */
 bool FT232_MPSSE::set(Gpio gpio, const GpioState state)
+{
+    //C8 & C9 are not controllable as GPIO pins in MPSSE mode
+    if (static_cast<int>(gpio) > static_cast<int>(Gpio::C7))
+        return false;
+
+    const auto mask = static_cast<uint8_t>(Bitwise::shift(portBit(gpio)));
+    return writePort(portOf(gpio), state == GpioState::High ? mask : 0x00, mask);
+}
+
+bool FT232_MPSSE::writePort(const Port port, const uint8_t value, const uint8_t mask)
 {
     if (_handle == nullptr)
         return false;
 
-    // Check if the specified pin is a valid I/O pin and configured as an output
-    if (_pinsState.at(gpio) == GpioState::Unknown || _pinsMode.at(gpio) != PinMode::Output)
+    // Exclusive lock for write access, a concurrent pinsMode() can't change the directions checked below
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+    // Check if the specified pins are valid I/O pins and configured as an output
+    const uint16_t pins = static_cast<uint16_t>(mask << portOffset(port));
+    const uint16_t directions = _directions.load();
+    if ((pins & directions) != pins || (pins & _specialFunctions.load()))
     {
-        std::cerr << "Pin " << static_cast<int>(gpio) << " is not configured is not a valid I/O pin or is not "
-                                                         " configured as an output" << std::endl;
+        std::cerr << "Port pins 0x" << std::hex << static_cast<int>(mask) << std::dec << " are not valid I/O pins or are not "
+                                                                                    " configured as an output" << std::endl;
         return false;
     }
 
-    // Read current configuration
-    uint32_t currentMask = 0x00;
-    for (const auto& [pinNumber, pinState] : _pinsState)    
+    // Replace the selected bits of the current values
+    const uint16_t values = (_values.load() & ~pins) | (static_cast<uint16_t>(value << portOffset(port)) & pins);
+
+    if (!writePortCommand(port, values, directions))
+        return false;
+
+    _values.store(values);
+    return true;
+}
+
+bool FT232_MPSSE::get(Gpio gpio, GpioState& state)
+{
+
+    if (_handle == nullptr)
+        return false;
+
+    // Check if the specified pin is configured as an input
+    if (static_cast<int>(gpio) > static_cast<int>(Gpio::C7) || !Bitwise::getBitState(inputMask(), static_cast<int>(gpio)))
     {
-        if (pinState == GpioState::High)
-        {
-            Bitwise::setBit(currentMask, static_cast<int>(pinNumber));
-        }
-        else
-        {
-            Bitwise::clearBit(currentMask, static_cast<int>(pinNumber));
-        }
+        std::cerr << "Pin " << static_cast<int>(gpio) << " is not configured as an input" << std::endl;
+        return false;
     }
 
-    auto newMask = currentMask;
-
-    //Handle the requested state
-    if (state == GpioState::High)
+    uint8_t value = 0;
+    if (readPort(portOf(gpio), value))
     {
-        // Set bit for OUTPUT mode
-        Bitwise::setBit(newMask, static_cast<int>(gpio));
+        state = Bitwise::getBitState(value, portBit(gpio)) ? GpioState::High : GpioState::Low;
+        return true;
     }
-    else
+
+    std::cerr << "Error reading pin " << static_cast<int>(gpio) << std::endl;
+    return false;
+}
+
+bool FT232_MPSSE::readPort(const Port port, uint8_t& value)
+{
+    if (_handle == nullptr)
+        return false;
+
+    uint8_t response[1];
+
+    // The pending commands are sent with the read command
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+    if (!reserveCommands(2) || !_commands.getDataBits(port == Port::C) || !flushCommands(response, sizeof(response)))
     {
-        // Clear bit for INPUT mode
-        Bitwise::clearBit(newMask, static_cast<int>(gpio));
+        std::cerr << "Failed to read GPIO port" << std::endl;
+        return false;
     }
 
-    uint8_t gpioCommand[3];
-    if(static_cast<int>(gpio) > 7)
+    value = response[0];
+    return true;
+}
+
+void FT232_MPSSE::beginBatch()
+{
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+    // The batch belongs to the thread opening it, the writes of the other threads are sent right away
+    if (_batchDepth == 0)
     {
-        gpioCommand[0] = static_cast<uint8_t>(MpsseCommand::SetDataBitsHighbyte);//[C0:C7)
-        //select C0:C7 (Most significant bit)
-        gpioCommand[1] = newMask >> 8 & 0xFF;//ex: b00001001 01000000 --> selection >> 8 & 0xFF : b01000000
+        _batchOwner = std::this_thread::get_id();
     }
-    else
+    if (_batchOwner == std::this_thread::get_id())
     {
-        gpioCommand[0] = static_cast<uint8_t>(MpsseCommand::SetDataBitsLowbyte);//[D0:D7)
-        //select D0:D7 (Low significant bit)
-        gpioCommand[1] = newMask & 0xF0;//ex: b00001001 01000000 --> selection & 0xF0 : b00001001 & maintain the first 4 bits to 0 because there has a special functions with i2c ( clck, data...)
+        ++_batchDepth;
     }
+}
 
-    gpioCommand[2] = _dir;
-
-    unsigned long bytesWritten = 0;
+bool FT232_MPSSE::endBatch()
+{
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+    if (_batchDepth == 0 || _batchOwner != std::this_thread::get_id())
+        return true;
+    if (--_batchDepth > 0)
+        return true;
 
-    const auto status = writeToDevice(gpioCommand, sizeof(gpioCommand), bytesWritten);
-    // auto status = FT_Write(_handle, gpioCommand, sizeof(gpioCommand), &bytesWritten);
-    if (status != true) {
-        std::cerr << "Failed to write to GPIO (error code: " << status << ")" << std::endl;
-        closeHandle();
-        return false;
-    }
+    _batchOwner = std::thread::id();
+    return flushCommands(nullptr, 0);
+}
 
-    _pinsState.at(gpio) = state;
-    return true;
+// The caller must hold _mutex
+bool FT232_MPSSE::batching() const
+{
+    return _batchDepth > 0 && _batchOwner == std::this_thread::get_id();
 }
 
-bool FT232_MPSSE::get(Gpio gpio, GpioState& state)
+std::chrono::nanoseconds FT232_MPSSE::waveformResolution() const
 {
+    return std::chrono::nanoseconds(1000000000 / _bitRate.load());
+}
 
+/*
+   Exemple (10 us pulse on C2 at 1 MHz):
+   0x82, 0x04, 0xFF : C2 high
+   0x8E, 0x07       : clock 8 bits (8 us)
+   0x8E, 0x01       : clock 2 bits (2 us)
+   0x82, 0x00, 0xFF : C2 low
+   The D0:D3 pins are released (inputs) by the waveform so the delay clocks never reach the I2C bus.
+ */
+bool FT232_MPSSE::playWaveform(const Waveform& waveform)
+{
     if (_handle == nullptr)
         return false;
 
-    // Check if the specified pin is configured as an input
-    if (_pinsMode.at(gpio) != PinMode::Input || _pinsState.at(gpio) == GpioState::Unknown)
+    if (!waveform.valid())
     {
-        std::cerr << "Pin " << static_cast<int>(gpio) << " is not configured as an input" << std::endl;
+        std::cerr << "Invalid waveform" << std::endl;
         return false;
     }
 
-    UCHAR readBuffer[10];
+    const auto bitRate = static_cast<uint64_t>(_bitRate.load());
+
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
 
-    if (static_cast<int>(gpio) > 7)
+    const auto directions = _directions.load();
+    for (const auto& step : waveform.steps())
     {
-        if(readAllPins(static_cast<uint8_t>(MpsseCommand::GetDataBitsHighbyte), *readBuffer))
+        const uint16_t pins = static_cast<uint16_t>(step.mask << portOffset(step.port));
+        if ((pins & directions) != pins || (pins & _specialFunctions.load()))
         {
-            state = Bitwise::getBitState(readBuffer[0], static_cast<int>(gpio) - 8) ? GpioState::High : GpioState::Low;
-            return true;
+            std::cerr << "Waveform pins 0x" << std::hex << static_cast<int>(step.mask) << std::dec << " are not valid I/O pins or are not "
+                                                                                             " configured as an output" << std::endl;
+            return false;
         }
     }
-    else
+
+    // Hold of a step in MPSSE clock periods
+    auto holdBits = [bitRate](const Waveform::Step& step)
+    {
+        return step.hold.count() > 0 ? (static_cast<uint64_t>(step.hold.count()) * bitRate + 500000000) / 1000000000 : 0;
+    };
+    constexpr uint64_t maxBits = 0x10000 * 8;
+
+    // Compiled size: D0:D3 release + one set command per step + its delay commands
+    size_t size = 3;
+    for (const auto& step : waveform.steps())
     {
-        if(readAllPins(static_cast<uint8_t>(MpsseCommand::GetDataBitsLowbyte), *readBuffer))
+        size += 3;
+        for (auto bits = holdBits(step); bits > 0; bits -= std::min(bits, maxBits))
         {
-            state = Bitwise::getBitState(readBuffer[0], static_cast<int>(gpio)) ? GpioState::High : GpioState::Low;
-            return true;
+            size += MpsseCommandBuffer::clockNoDataSize(static_cast<uint32_t>(std::min(bits, maxBits)));
         }
     }
 
-    std::cerr << "Error reading pin " << static_cast<int>(gpio) << std::endl;
-    return false;
+    // +1: Send immediate. A flush in the middle would put a USB gap inside the train
+    if (size + 1 > MpsseCommandBuffer::Capacity)
+    {
+        std::cerr << "Waveform too long for one USB write (" << size << " bytes of commands)" << std::endl;
+        return false;
+    }
+
+    // The queued commands go first, in the same transfer if the waveform fits after them
+    if (!reserveCommands(size))
+        return false;
+
+    uint16_t values = _values.load();
+
+    // Release D0:D3 (SCL, SDA...) before clocking
+    _commands.setDataBits(false, values & 0xF0, directions & 0xF0);
+
+    for (const auto& step : waveform.steps())
+    {
+        const uint16_t pins = static_cast<uint16_t>(step.mask << portOffset(step.port));
+        values = (values & ~pins) | (static_cast<uint16_t>(step.value << portOffset(step.port)) & pins);
+
+        _commands.setDataBits(step.port == Port::C,
+                              step.port == Port::C ? values >> 8 & 0xFF : values & 0xF0,
+                              step.port == Port::C ? directions >> 8 & 0xFF : directions & 0xF0);
+
+        for (auto bits = holdBits(step); bits > 0; bits -= std::min(bits, maxBits))
+        {
+            _commands.clockNoData(static_cast<uint32_t>(std::min(bits, maxBits)));
+        }
+    }
+
+    if (!flushCommands(nullptr, 0))
+        return false;
+
+    _values.store(values);
+    return true;
+}
+
+std::future<bool> FT232_MPSSE::setAsync(const Gpio gpio, const GpioState state)
+{
+    return _executor.submit([this, gpio, state]() { return set(gpio, state); });
+}
+
+std::future<io::inOut::GpioState> FT232_MPSSE::getAsync(const Gpio gpio)
+{
+    return _executor.submit([this, gpio]()
+    {
+        GpioState state = GpioState::Unknown;
+        return get(gpio, state) ? state : GpioState::Unknown;
+    });
+}
+
+std::future<bool> FT232_MPSSE::writePortAsync(const Port port, const uint8_t value, const uint8_t mask)
+{
+    return _executor.submit([this, port, value, mask]() { return writePort(port, value, mask); });
+}
+
+std::future<int> FT232_MPSSE::readWordAsync(const uint8_t addr, const uint8_t cmd)
+{
+    return _executor.submit([this, addr, cmd]()
+    {
+        uint16_t value = 0;
+        return readWord(addr, cmd, value) == 0 ? static_cast<int>(value) : -1;
+    });
+}
+
+std::future<int> FT232_MPSSE::writeWordAsync(const uint8_t addr, const uint8_t cmd, const uint16_t value)
+{
+    return _executor.submit([this, addr, cmd, value]() { return writeWord(addr, cmd, value); });
+}
+
+int FT232_MPSSE::setSpeed(const I2CMaster::Speed speed)
+{
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+    if (_handle == nullptr)
+    {
+        std::cerr << "Need to be initialized before use" << std::endl;
+        return -1;
+    }
+
+    uint32_t clockRate = 0;
+    if (!clockRateOf(speed, clockRate))
+    {
+        std::cerr << "Unsupported I2C speed" << std::endl;
+        return -1;
+    }
+
+    if (!flushCommands(nullptr, 0))
+        return -1;
+
+    // I2C_InitChannel resets the GPIO pins, the shadow registers are replayed afterwards
+    if (-1 == configureChannel(_handle, speed))
+    {
+        closeHandle();
+        return -1;
+    }
+
+    // The speed is kept for the reconnections
+    _speed.store(speed);
+    return restorePins() ? 0 : -1;
+}
+
+// Configure an opened channel in I2C mode
+int FT232_MPSSE::configureChannel(Ft232Transport::Handle handle, const I2CMaster::Speed speed)
+{
+    // I2C channel configuration
+    Ft232Transport::ChannelConfig channelConf;
+    channelConf.latencyTimer = 16;
+    /* initial dir and values are used for initchannel API and final dir and values are used by CloseChannel API */
+    // D4:D7 start from the shadow registers (SCL & SDA driven high) and end as low outputs (I2C lines released)
+    const uint16_t values = _values.load();
+    const uint16_t directions = _directions.load();
+    const uint32_t initialDirection = 0x03 | (directions & 0xF0);
+    const uint32_t initialValues = 0x03 | (values & 0xF0);
+    channelConf.pin = initialDirection |                /* BIT7   -BIT0:   Initial direction of the pins	*/
+        initialValues << 8 |                            /* BIT15 -BIT8:   Initial values of the pins		*/
+        static_cast<uint32_t>(FinalDirection & 0xF0) << 16 |/* BIT23 -BIT16: Final direction of the pins		*/
+        static_cast<uint32_t>(FinalValues) << 24;          /* BIT31 -BIT24: Final values of the pins		*/
+    channelConf.options = Ft232Transport::ChannelPinStateConfig; /* set this option to enable GPIO_Lx pinstate management */
+   
+    if (!clockRateOf(speed, channelConf.clockRate))
+    {
+        std::cerr << "Unsupported I2C speed" << std::endl;
+        return -1;
+    }
+
+    const auto status = _transport->initChannel(handle, channelConf);
+    if (status != Ft232Transport::Ok)
+    {
+        std::cerr << "Error configuring I2C channel." << std::endl;
+        return -1;
+    }
+
+    // libMPSSE sets the MPSSE clock so that one clocked bit lasts one I2C bit time
+    _bitRate.store(channelConf.clockRate);
+    return 0;
+}
+
+// I2C write transaction, the caller must hold the exclusive lock of _mutex
+int FT232_MPSSE::deviceWrite(const uint8_t addr, const uint8_t* buffer, const uint32_t size, const uint32_t options)
+{
+    // The fast bits transfers are counted in bits
+    const bool bits = (options & Ft232Transport::TransferFastBits) != 0;
+    if (bits && size > UINT32_MAX / 8)
+        return -1;
+
+    uint32_t transferred = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const auto status = _transport->deviceWrite(_handle, addr, buffer, bits ? size * 8 : size, transferred, options);
+    transferred = bits ? transferred / 8 : transferred;
+    _deviceWriteMetrics.record(std::chrono::steady_clock::now() - start,
+                               status == Ft232Transport::Ok && transferred == size, transferred);
+    if (status != Ft232Transport::Ok)
+    {
+        std::cerr << "I2C_DeviceWrite(0x" << std::hex << static_cast<int>(addr) << std::dec << ") : Error(" << status << ")" << std::endl;
+        closeHandle();
+        return -1;
+    }
+    return static_cast<int>(transferred);
+}
+
+// I2C read transaction, the caller must hold the exclusive lock of _mutex
+int FT232_MPSSE::deviceRead(const uint8_t addr, uint8_t* buffer, const uint32_t size, const uint32_t options)
+{
+    // The fast bits transfers are counted in bits
+    const bool bits = (options & Ft232Transport::TransferFastBits) != 0;
+    if (bits && size > UINT32_MAX / 8)
+        return -1;
+
+    uint32_t transferred = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const auto status = _transport->deviceRead(_handle, addr, buffer, bits ? size * 8 : size, transferred, options);
+    transferred = bits ? transferred / 8 : transferred;
+    _deviceReadMetrics.record(std::chrono::steady_clock::now() - start,
+                              status == Ft232Transport::Ok && transferred == size, transferred);
+    if (status != Ft232Transport::Ok)
+    {
+        std::cerr << "I2C_DeviceRead(0x" << std::hex << static_cast<int>(addr) << std::dec << ") : Error(" << status << ")" << std::endl;
+        closeHandle();
+        return -1;
+    }
+    return static_cast<int>(transferred);
+}
+
+// The caller must hold the exclusive lock of _mutex
+bool FT232_MPSSE::beginTransaction()
+{
+    if (_handle == nullptr)
+    {
+        std::cerr << "Need to be initialized before use" << std::endl;
+        return false;
+    }
+
+    // The queued GPIO commands go first
+    return flushCommands(nullptr, 0);
+}
+
+int FT232_MPSSE::getSpeed(I2CMaster::Speed& speed) const
+{
+    speed = _speed.load();
+    return 0;
+}
+
+int FT232_MPSSE::setTransferMode(const TransferMode mode)
+{
+    if (mode == TransferMode::Default)
+        return -1;
+
+    _transferMode.store(mode);
+    return 0;
+}
+
+I2C::I2CMaster::TransferMode FT232_MPSSE::transferMode() const
+{
+    return _transferMode.load();
+}
+
+// libMPSSE options of the transfer mode
+uint32_t FT232_MPSSE::transferOptions(const Transfer& transfer) const
+{
+    uint32_t options = transfer.noAddress ? Ft232Transport::TransferNoAddress : 0;
+    switch (transfer.mode == TransferMode::Default ? _transferMode.load() : transfer.mode)
+    {
+    case TransferMode::FastBytes:
+        options |= Ft232Transport::TransferFastBytes;
+        break;
+    case TransferMode::FastBits:
+        options |= Ft232Transport::TransferFastBits;
+        break;
+    default:
+        break;
+    }
+    return options;
+}
+
+int FT232_MPSSE::read(const uint8_t addr, uint8_t* buf, const size_t len)
+{
+    return read(addr, buf, len, Transfer{});
 }
 
-int FT232_MPSSE::setSpeed(I2CMaster::Speed speed)
+int FT232_MPSSE::write(const uint8_t addr, const uint8_t* buf, const size_t len)
 {
-    // I2C channel configuration
-    ChannelConfig channelConf;
-    channelConf.currentPinState = 0; // Current pin status (not used for I2C)
-    channelConf.LatencyTimer = 16;
-    //channelConf.Pin = InitialDirection | /* BIT7   -BIT0:   Initial direction of the pins	*/
-    //    InitialValues << 8 | /* BIT15 -BIT8:   Initial values of the pins		*/
-    //    FinalDirection << 16 | /* BIT23 -BIT16: Final direction of the pins		*/
-    //    FinalValues << 24;
-    /* initial dir and values are used for initchannel API and final dir and values are used by CloseChannel API */
-    //channelConf.Pin = (1 << 0) | (1 << 1); // Set D0 and D1 as I2C pins
-    channelConf.Pin = 0;
-    channelConf.Options = 0; /* set this option to enable GPIO_Lx pinstate management */
-   
-    switch (speed)
-    {
-    case Speed::_10kbs:
+    return write(addr, buf, len, Transfer{});
+}
+
+int FT232_MPSSE::writeRead(const uint8_t addr, const uint8_t* out, const size_t outLen, uint8_t* in, const size_t inLen)
+{
+    return writeRead(addr, out, outLen, in, inLen, Transfer{});
+}
+
+int FT232_MPSSE::read(const uint8_t addr, uint8_t* buf, const size_t len, const Transfer& transfer)
+{
+    if (len > UINT32_MAX)
         return -1;
-    case Speed::_100kbs:
-        channelConf.ClockRate = I2C_CLOCK_STANDARD_MODE;
-        break;
-    case Speed::_200kbs:
+
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+    if (!beginTransaction())
         return -1;
-    case Speed::_400kbs:
-        channelConf.ClockRate = I2C_CLOCK_FAST_MODE;
-        break;
-    case Speed::_1mbs:
-        channelConf.ClockRate = I2C_CLOCK_FAST_MODE_PLUS;
-        break;
-    case Speed::_17mbs:
+    if (len == 0)
+        return 0;
+
+    const auto bytes = static_cast<uint32_t>(len);
+    const auto transferred = deviceRead(addr, buf, bytes,
+                                        Ft232Transport::TransferStartBit |
+                                        Ft232Transport::TransferStopBit |
+                                        Ft232Transport::TransferNackLastByte |
+                                        transferOptions(transfer));
+    if (transferred >= 0 && static_cast<uint32_t>(transferred) != bytes)
+    {
+        std::cerr << "FT232_Read : " << transferred << "/" << bytes << " bytes read from 0x" << std::hex << static_cast<int>(addr) << std::dec << std::endl;
         return -1;
-    case Speed::_34mbs:
-        channelConf.ClockRate = I2C_CLOCK_HIGH_SPEED_MODE;
-        break;
     }
+    return transferred;
+}
+
+int FT232_MPSSE::write(const uint8_t addr, const uint8_t* buf, const size_t len, const Transfer& transfer)
+{
+    if (len > UINT32_MAX)
+        return -1;
 
-    const auto status = I2C_InitChannel(_handle, &channelConf);
-    if (status != FT_OK)
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+    if (!beginTransaction())
+        return -1;
+    if (len == 0)
+        return 0;
+
+    const auto bytes = static_cast<uint32_t>(len);
+    const auto transferred = deviceWrite(addr, buf, bytes,
+                                         Ft232Transport::TransferStartBit |
+                                         Ft232Transport::TransferStopBit |
+                                         transferOptions(transfer));
+    if (transferred >= 0 && static_cast<uint32_t>(transferred) != bytes)
     {
-        std::cerr << "Error configuring I2C channel." << std::endl;
-        closeHandle();
+        std::cerr << "FT232_Write : " << transferred << "/" << bytes << " bytes written to 0x" << std::hex << static_cast<int>(addr) << std::dec << std::endl;
         return -1;
     }
-
-    return 0;
+    return transferred;
 }
 
-int FT232_MPSSE::readWord(const uint8_t addr, uint8_t cmd, uint16_t& value)
+int FT232_MPSSE::writeRead(const uint8_t addr, const uint8_t* out, const size_t outLen, uint8_t* in, const size_t inLen,
+                           const Transfer& transfer)
 {
-    if (_handle == nullptr)
+    if (outLen == 0 || outLen > UINT32_MAX || inLen > UINT32_MAX)
+        return -1;
+
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+    if (!beginTransaction())
+        return -1;
+
+    // No stop: the read starts with a repeated start condition
+    const auto written = deviceWrite(addr, out, static_cast<uint32_t>(outLen),
+                                     Ft232Transport::TransferStartBit |
+                                     (inLen == 0 ? Ft232Transport::TransferStopBit : 0) |
+                                     transferOptions(transfer));
+    if (written < 0)
+        return -1;
+    if (static_cast<size_t>(written) != outLen)
     {
-        std::cerr << "Need to be initialized before use" << std::endl;
+        std::cerr << "FT232_WriteRead : " << written << "/" << outLen << " bytes written to 0x" << std::hex << static_cast<int>(addr) << std::dec << std::endl;
         return -1;
     }
-
-    DWORD xfer = 0;
-    FT_STATUS status = I2C_DeviceWrite(_handle, addr, sizeof(cmd), &cmd, &xfer,
-        I2C_TRANSFER_OPTIONS_START_BIT |
-        I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BYTES
-    );
-    if (status != FT_OK || xfer != sizeof(cmd))
+    if (inLen == 0)
+        return 0;
+
+    const auto bytes = static_cast<uint32_t>(inLen);
+    // The repeated start addresses the slave again
+    const auto transferred = deviceRead(addr, in, bytes,
+                                        Ft232Transport::TransferStartBit |
+                                        Ft232Transport::TransferStopBit |
+                                        Ft232Transport::TransferNackLastByte |
+                                        transferOptions(Transfer{ transfer.mode, false }));
+    if (transferred >= 0 && static_cast<uint32_t>(transferred) != bytes)
     {
-        closeHandle();
+        std::cerr << "FT232_WriteRead : " << transferred << "/" << bytes << " bytes read from 0x" << std::hex << static_cast<int>(addr) << std::dec << std::endl;
         return -1;
     }
-    /* Repeated Start condition generated. */
-    uint8_t data[2] = { 0, 0 };
-    xfer = 0;
-    status = I2C_DeviceRead(_handle, addr, sizeof(data), data, &xfer,
-        I2C_TRANSFER_OPTIONS_START_BIT |
-        I2C_TRANSFER_OPTIONS_STOP_BIT |
-        I2C_TRANSFER_OPTIONS_NACK_LAST_BYTE |
-        I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BYTES
-    );
+    return transferred;
+}
 
-    if ((status != FT_OK) || (xfer != sizeof(data)))
+int FT232_MPSSE::readWord(const uint8_t addr, uint8_t cmd, uint16_t& value)
+{
+    uint8_t data[2] = { 0, 0 };
+    if (writeRead(addr, &cmd, sizeof(cmd), data, sizeof(data)) != sizeof(data))
     {
-        std::cerr << "FT232_ReadWord : Error(" << status << ")" << std::endl;
-        closeHandle();
+        std::cerr << "FT232_ReadWord : Error" << std::endl;
         return -1;
     }
     value = static_cast<uint16_t>(data[0]) + static_cast<uint16_t>(data[1] << 8);
@@ -360,29 +885,20 @@ int FT232_MPSSE::readWord(const uint8_t addr, uint8_t cmd, uint16_t& value)
 int FT232_MPSSE::writeWord(const uint8_t slaveAddress, const uint8_t cmd, const uint16_t value)
 {
     const std::unique_lock<std::shared_mutex> lock(_mutex);
-    if (_handle == nullptr)
-    {
-        std::cerr << "Need to be initialized before use" << std::endl;
+    if (!beginTransaction())
         return -1;
-    }
 
     uint8_t buffer[3];
-    uint32_t bytesTransfered;
-    bool writeComplete = false;
-    uint32_t retry = 0;
     uint32_t bytesToTransfer = 0;
-    bytesTransfered = 0;
     buffer[bytesToTransfer++] = cmd; /* Byte addressed inside EEPROM */
     buffer[bytesToTransfer++] = static_cast<uint8_t>(value);
-    auto status = I2C_DeviceWrite(_handle, slaveAddress, bytesToTransfer, buffer,
-                                  reinterpret_cast<LPDWORD>(&bytesTransfered),
-                                  I2C_TRANSFER_OPTIONS_START_BIT | 
-                                  I2C_TRANSFER_OPTIONS_STOP_BIT);
-
-    if ((status != FT_OK) || (bytesTransfered != bytesToTransfer))
+    const auto bytesTransfered = deviceWrite(slaveAddress, buffer, bytesToTransfer,
+                                             Ft232Transport::TransferStartBit |
+                                             Ft232Transport::TransferStopBit |
+                                             transferOptions(Transfer{}));
+    if (bytesTransfered != static_cast<int>(bytesToTransfer))
     {
-        std::cerr << "FT232_ReadWord : Error(" << status << ")" << std::endl;
-        closeHandle();
+        std::cerr << "FT232_WriteWord : Error" << std::endl;
         return -1;
     }
 
@@ -410,6 +926,12 @@ int FT232_MPSSE::writeWord(const uint8_t slaveAddress, const uint8_t cmd, const
     return 0;
 }
 
+/*
+   D0:D7 and C0:C7 are sampled by the same USB transfer:
+   0x81: Mpsse command to read D[7:0].
+   0x83: Mpsse command to read C[7:0].
+   0x87: Send immediate, flush the 2 answered bytes back to the host.
+ */
 bool FT232_MPSSE::getPinsState(uint16_t& pinsState)
 {
     if (_handle == nullptr)
@@ -418,31 +940,45 @@ bool FT232_MPSSE::getPinsState(uint16_t& pinsState)
         return false;
     }
 
-    UCHAR readBufferHigh[10];
-    UCHAR readBufferLow[10];
+    uint8_t response[2];
+
+    // Keep the commands and their answer together
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
 
-    if(!readAllPins(static_cast<uint8_t>(MpsseCommand::GetDataBitsHighbyte), *readBufferHigh))
+    if (!reserveCommands(3) ||
+        !_commands.getDataBits(false) ||
+        !_commands.getDataBits(true) ||
+        !flushCommands(response, sizeof(response)))
     {
-        std::cerr << "Error reading C0:C7 High byte pins" << std::endl;
+        std::cerr << "Failed to read D0:D7 & C0:C7 pins state" << std::endl;
         return false;
     }
 
-    Sleep(100);
+    pinsState = static_cast<uint16_t>(response[0]) | static_cast<uint16_t>(response[1] << 8);
+
+    return true;
+}
 
-    if (!readAllPins(static_cast<uint8_t>(MpsseCommand::GetDataBitsLowbyte), *readBufferLow))
+// The caller must hold the exclusive lock of _mutex
+bool FT232_MPSSE::writeToDevice(uint8_t *buffer, uint32_t bytesToTransfer, uint32_t& bytesTransfered)
+{
+    if (_handle == nullptr)
     {
-        std::cerr << "Error reading D0:D7 Low byte pins" << std::endl;
+        std::cerr << "Need to be initialized before use" << std::endl;
         return false;
     }
 
-
-    pinsState = static_cast<uint16_t>(readBufferLow[0]) | static_cast<uint16_t>(readBufferHigh[0] << 8);
-
+    const auto start = std::chrono::steady_clock::now();
+    const auto status = _transport->write(_handle, buffer, bytesToTransfer, bytesTransfered);
+    _writeMetrics.record(std::chrono::steady_clock::now() - start, status == Ft232Transport::Ok, bytesTransfered);
+    if (status != Ft232Transport::Ok) {
+        return false;
+    }
     return true;
-
 }
 
-bool FT232_MPSSE::writeToDevice(uint8_t *buffer, DWORD bytesToTransfer, DWORD& bytesTransfered)
+// The caller must hold the exclusive lock of _mutex
+bool FT232_MPSSE::readFromDevice(uint8_t *buffer, uint32_t bytesToTransfer, uint32_t& bytesTransfered)
 {
     if (_handle == nullptr)
     {
@@ -450,100 +986,133 @@ bool FT232_MPSSE::writeToDevice(uint8_t *buffer, DWORD bytesToTransfer, DWORD& b
         return false;
     }
 
-    const std::unique_lock<std::shared_mutex> lock(_mutex);
-    if (const auto status = FT_Write(_handle, buffer, bytesToTransfer, &bytesTransfered); status != FT_OK) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto status = _transport->read(_handle, buffer, bytesToTransfer, bytesTransfered);
+    _readMetrics.record(std::chrono::steady_clock::now() - start, status == Ft232Transport::Ok, bytesTransfered);
+    if (status != Ft232Transport::Ok) {
+        std::cerr << "Failed to read from device ---> error code(" << status << ")" << std::endl;
         return false;
     }
     return true;
 }
 
-bool FT232_MPSSE::clearAllPins()
+// Make room for the next command, the caller must hold the exclusive lock of _mutex
+bool FT232_MPSSE::reserveCommands(const size_t bytes)
 {
+    // +1: Send immediate
+    if (_commands.remaining() >= bytes + 1)
+        return true;
 
-    if (_handle == nullptr)
+    return flushCommands(nullptr, 0);
+}
+
+/*
+   Send all the queued commands in one USB write and, if some of them are read commands, collect all their
+   answers in one USB read. The caller must hold the exclusive lock of _mutex.
+ */
+bool FT232_MPSSE::flushCommands(uint8_t* response, const size_t responseSize)
+{
+    if (_commands.empty())
+        return true;
+
+    const auto expected = _commands.expectedResponse();
+    if (expected > responseSize || !_commands.sendImmediate())
     {
-        std::cerr << "Need to be initialized before use" << std::endl;
+        std::cerr << "Unexpected MPSSE answer size (" << expected << " bytes)" << std::endl;
+        _commands.clear();
         return false;
     }
 
-    //Clear all D4:D7 pins
-    // 0x80: Mpsse Command to set D[7:0].
-    // 0x00: Output values for D[7:0] (placeholder)
-    // 0xF0: GPIO directions for D[7:0] (1 = output, 0 = input)
-    uint8_t gpioCommand[] = { 0x80, 0x00, 0xF0 };
-    unsigned long bytesWritten = 0;
-    auto status = FT_Write(_handle, gpioCommand, sizeof(gpioCommand), &bytesWritten);
-    if (status != FT_OK) {
-        std::cerr << "Failed to write to GPIO (error code: " << status << ")" << std::endl;
+    uint32_t bytesTransfered = 0;
+    const auto bytesToTransfer = static_cast<uint32_t>(_commands.size());
+    const bool written = writeToDevice(_commands.data(), bytesToTransfer, bytesTransfered) &&
+                         bytesTransfered == bytesToTransfer;
+    _commands.clear();
+    if (!written)
+    {
+        std::cerr << "Failed to write MPSSE commands" << std::endl;
         closeHandle();
         return false;
     }
 
-    //Clear all c0:c7 pins
-    // 0x82: Mpsse Command to set C[7:0].
-    // 0x00: Output values for C[7:0] (placeholder)
-    // 0xFF: GPIO directions for C[7:0] (1 = output)
-    uint8_t buffer[3] = { 0x82, 0x00, 0xFF };
-    status = FT_Write(_handle, buffer, sizeof(buffer), &bytesWritten);
-    if (status != FT_OK) {
-        std::cerr << "Failed to write to GPIO (error code: " << status << ")" << std::endl;
+    if (expected == 0)
+        return true;
+
+    bytesTransfered = 0;
+    if (!readFromDevice(response, static_cast<uint32_t>(expected), bytesTransfered))
+    {
         closeHandle();
         return false;
     }
+    if (bytesTransfered != expected)
+    {
+        std::cerr << "bytesToTransfer different then bytesTransfered (" << Ft232Transport::IoError << ")" << std::endl;
+        return false;
+    }
 
     return true;
 }
 
-bool FT232_MPSSE::readAllPins(uint8_t cmd, uint8_t& result)
+// The caller must hold the exclusive lock of _mutex
+bool FT232_MPSSE::writePortCommand(const Port port, const uint16_t values, const uint16_t directions)
 {
-    if (_handle == nullptr)
-    {
-        std::cerr << "Need to be initialized before use" << std::endl;
+    if (!reserveCommands(3))
         return false;
+
+    if (port == Port::C)
+    {
+        //select C0:C7 (Most significant bit)
+        _commands.setDataBits(true, values >> 8 & 0xFF, directions >> 8 & 0xFF);//ex: b00001001 01000000 --> selection >> 8 & 0xFF : b00001001
+    }
+    else
+    {
+        //select D0:D7 (Low significant bit) & maintain the first 4 bits to 0 because there has a special functions with i2c ( clck, data...)
+        _commands.setDataBits(false, values & 0xF0, directions & 0xF0);//ex: b00001001 01000000 --> selection & 0xF0 : b01000000
     }
 
-    uint8_t buffer[2];
-    DWORD bytesTransfered = 0;
-    DWORD bytesToTransfer = 0;
-    UCHAR readBuffer[10];
+    // Inside a batch the command is sent with the next ones
+    return batching() || flushCommands(nullptr, 0);
+}
 
-    buffer[bytesToTransfer++] = cmd;
-    buffer[bytesToTransfer++] = static_cast<uint8_t>(MpsseCommand::SendImmediate);
+// 16 bits mask of the GPIO pins configured as an input
+uint16_t FT232_MPSSE::inputMask() const
+{
+    return static_cast<uint16_t>(~(_directions.load() | _specialFunctions.load()));
+}
 
-    auto status = writeToDevice(buffer, bytesToTransfer, bytesTransfered);
-    if (status != true) {
-        std::cerr << "Failed to write to GPIO (error code: " << status << ")" << std::endl;
-        closeHandle();
+// The caller must hold the exclusive lock of _mutex
+bool FT232_MPSSE::clearAllPins()
+{
+
+    if (_handle == nullptr)
+    {
+        std::cerr << "Need to be initialized before use" << std::endl;
         return false;
     }
-  
-    bytesToTransfer = 1;
-    bytesTransfered = 0;
-    {
-        const std::unique_lock<std::shared_mutex> lock(_mutex);
-        status = FT_Read(_handle, readBuffer, bytesToTransfer, &bytesTransfered);
-        if (status != FT_OK) {
-            std::cerr << "Failed to read pin D0 state ---> error code(" << status << ")" << std::endl;
-            closeHandle();
-            return false;
-        }
-        if (bytesToTransfer != bytesTransfered)
-        {
-            std::cerr << "bytesToTransfer different then bytesTransfered (" << FT_IO_ERROR << ")" << std::endl;
-            return false;
-        }
 
-        result = readBuffer[0];
+    //Clear all D4:D7 & c0:c7 pins
+    // 0x80: Mpsse Command to set D[7:0], 0x00: Output values, 0xF0: GPIO directions (1 = output, 0 = input)
+    // 0x82: Mpsse Command to set C[7:0], 0x00: Output values, 0xFF: GPIO directions (1 = output)
+    const auto directions = static_cast<uint16_t>(~_specialFunctions.load());
+    if (!reserveCommands(6) ||
+        !_commands.setDataBits(false, 0x00, directions & 0xF0) ||
+        !_commands.setDataBits(true, 0x00, directions >> 8 & 0xFF) ||
+        !flushCommands(nullptr, 0))
+    {
+        std::cerr << "Failed to clear the GPIO pins" << std::endl;
+        return false;
     }
 
+    _values.store(0x0000);
+    _directions.store(directions);
     return true;
 }
 
-int FT232_MPSSE::openCahnnel(const DWORD channelIndex)
+int FT232_MPSSE::openCahnnel(const uint32_t channelIndex, Ft232Transport::Handle& handle)
 {
     // Opening the I2C channel
-    const FT_STATUS status = I2C_OpenChannel(channelIndex, &_handle);
-    if (status != FT_OK)
+    const auto status = _transport->openChannel(channelIndex, handle);
+    if (status != Ft232Transport::Ok)
     {
         std::cerr << "Error opening I2C channel." << std::endl;
         return -1;
@@ -552,128 +1121,398 @@ int FT232_MPSSE::openCahnnel(const DWORD channelIndex)
     return 0;
 }
 
+// The caller must hold the exclusive lock of _mutex
 void FT232_MPSSE::closeHandle()
 {
-    I2C_CloseChannel(_handle);
+    if (_handle != nullptr)
+    {
+        _transport->closeChannel(_handle);
+    }
     _handle = nullptr;
+    _commands.clear();
 }
 
-int FT232_MPSSE::init()
+/*
+   Replay the shadow registers (directions and output values of D4:D7 and C0:C7) in one transfer,
+   the caller must hold the exclusive lock of _mutex.
+ */
+bool FT232_MPSSE::restorePins()
 {
-    const std::unique_lock<std::shared_mutex> lock(_mutex);
+    const uint16_t values = _values.load();
+    const uint16_t directions = _directions.load();
+    if (!reserveCommands(6) ||
+        !_commands.setDataBits(false, values & 0xF0, directions & 0xF0) ||
+        !_commands.setDataBits(true, values >> 8 & 0xFF, directions >> 8 & 0xFF) ||
+        !flushCommands(nullptr, 0))
+    {
+        std::cerr << "Failed to restore the GPIO pins" << std::endl;
+        return false;
+    }
+    return true;
+}
 
-    // Initializing the libMPSSE library
-    Init_libMPSSE();
-   
-    if (_handle == nullptr)
+// Look up the selected channel among all the listed ones
+int FT232_MPSSE::openEnumerated(Ft232Transport::Handle& handle, ChannelInfo& channel)
+{
+    const auto channels = enumerate(*_transport);
+    printChannels(channels);
+
+    const auto selected = std::find_if(channels.begin(), channels.end(),
+                                       [this](const ChannelInfo& info) { return _selector.matches(info); });
+    if (selected == channels.end())
     {
-        unsigned long channels = 0;
-        auto status = I2C_GetNumChannels(&channels);
+        std::cerr << "No MPSSE channel matches the adapter selector" << std::endl;
+        return -1;
+    }
 
-        const DWORD channelIndex = 0;
-        for (unsigned long channel = 0; channel < channels; channel++)
-        {
-            FT_DEVICE_LIST_INFO_NODE devList;
-            status = I2C_GetChannelInfo(channel, &devList);
-            Sleep(1);
-            std::cout << "\t\t\t\t\t\tI2C_GetNumChannels returned " << status << " for channel = " << channel << std::endl;
-            /*print the dev info*/
-            std::cout << "\t\t\t\t\t\tFlags=0x" << devList.Flags << std::endl;
-            std::cout << "\t\t\t\t\t\tType=0x" << devList.Type << std::endl;
-            std::cout << "\t\t\t\t\t\tID=0x" << devList.ID << std::endl;
-            std::cout << "\t\t\t\t\t\tLocId=0x" << devList.LocId << std::endl;
-            std::cout << "\t\t\t\t\t\tSerialNumber=" << devList.SerialNumber << std::endl;
-            std::cout << "\t\t\t\t\t\tDescription=" << devList.Description << std::endl;
-            std::cout << "\t\t\t\t\t\tftHandle=" << devList.ftHandle << " (should be zero)" << std::endl;
-        }
+    channel = *selected;
+
+    //Open channel
+    return openCahnnel(selected->index, handle);
+}
 
-        Sleep(10);
+// Open the selected channel without listing the connected ones
+int FT232_MPSSE::openDirect(Ft232Transport::Handle& handle, ChannelInfo& channel)
+{
+    channel = _channel;
 
-        //Open channel
-        if(-1 == openCahnnel(channelIndex))
+    Ft232Transport::Status status;
+    if (!_channel.serialNumber.empty())
+    {
+        // Once opened, the serial number finds the adapter even if it was plugged on another port
+        status = _transport->openEx(Ft232Transport::OpenBy::SerialNumber, _channel.serialNumber, 0, handle);
+    }
+    else
+    {
+        switch (_selector.by)
         {
-            return -1;
+        case ChannelSelector::By::SerialNumber:
+            status = _transport->openEx(Ft232Transport::OpenBy::SerialNumber, _selector.value, 0, handle);
+            break;
+        case ChannelSelector::By::Description:
+            status = _transport->openEx(Ft232Transport::OpenBy::Description, _selector.value, 0, handle);
+            break;
+        case ChannelSelector::By::Location:
+            channel.locationId = _selector.locationId;
+            status = _transport->openEx(Ft232Transport::OpenBy::Location, std::string(), _selector.locationId, handle);
+            break;
+        case ChannelSelector::By::Index:
+        default:
+            channel.index = _selector.index;
+            status = _transport->openChannel(_selector.index, handle);
+            break;
         }
+    }
+
+    if (status != Ft232Transport::Ok)
+    {
+        std::cerr << "Error opening I2C channel." << std::endl;
+        return -1;
+    }
+
+    // Cache the identity of the adapter for the reconnections
+    Ft232Transport::DeviceInfo info;
+    if (_transport->getDeviceInfo(handle, info) == Ft232Transport::Ok)
+    {
+        channel.type = info.type;
+        channel.id = info.id;
+        channel.serialNumber = info.serialNumber;
+        channel.description = info.description;
+    }
+    return 0;
+}
+
+/*
+   Open and configure the selected channel, then replay the last known pins state.
+   The device lock is only taken to install the new handle, the API calls keep failing fast meanwhile.
+ */
+int FT232_MPSSE::init()
+{
+    // The constructor and the poll thread may open the channel concurrently
+    const std::lock_guard<std::mutex> openLock(_openMutex);
+    if (_handle != nullptr)
+        return 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    Ft232Transport::Handle handle = nullptr;
+    ChannelInfo channel;
+    const auto opened = _openMode == OpenMode::Fast ? openDirect(handle, channel) : openEnumerated(handle, channel);
+    if (-1 == opened)
+    {
+        return -1;
+    }
+
+    //set speed (the last one requested when reconnecting) and the D4:D7 pins
+    if (-1 == configureChannel(handle, _speed.load()))
+    {
+        _transport->closeChannel(handle);
+        return -1;
+    }
+
+    const std::unique_lock<std::shared_mutex> lock(_mutex);
+    _channel = channel;
+    _handle = handle;
+
+    // The outputs come back to their last values, all low on the first opening
+    if (!restorePins())
+    {
+        closeHandle();
+        return -1;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (_startupTime.count() == 0)
+    {
+        _startupTime = std::chrono::duration_cast<std::chrono::microseconds>(now - _created);
+        std::cout << "\t\t\t\t\t\tTime to first I/O = " << _startupTime.count() << " us" << std::endl;
+    }
+    else
+    {
+        std::cout << "\t\t\t\t\t\tReopened in " << std::chrono::duration_cast<std::chrono::microseconds>(now - start).count() << " us" << std::endl;
+    }
+    return 0;
+}
+
+void FT232_MPSSE::printChannels(const std::vector<ChannelInfo>& channels) const
+{
+    for (const auto& channel : channels)
+    {
+        std::cout << "\t\t\t\t\t\tI2C_GetChannelInfo for channel = " << channel.index << std::endl;
+        /*print the dev info*/
+        std::cout << "\t\t\t\t\t\tFlags=0x" << channel.flags << std::endl;
+        std::cout << "\t\t\t\t\t\tType=0x" << channel.type << std::endl;
+        std::cout << "\t\t\t\t\t\tID=0x" << channel.id << std::endl;
+        std::cout << "\t\t\t\t\t\tLocId=0x" << channel.locationId << std::endl;
+        std::cout << "\t\t\t\t\t\tSerialNumber=" << channel.serialNumber << std::endl;
+        std::cout << "\t\t\t\t\t\tDescription=" << channel.description << std::endl;
+    }
+}
+
+void FT232_MPSSE::setPollingConfig(const PollingConfig& config)
+{
+    const std::lock_guard<std::mutex> lock(_pollingMutex);
+    _pollingConfig = config;
+}
+
+FT232_MPSSE::PollingConfig FT232_MPSSE::pollingConfig() const
+{
+    const std::lock_guard<std::mutex> lock(_pollingMutex);
+    return _pollingConfig;
+}
+
+FT232_MPSSE::PollingStats FT232_MPSSE::pollingStats() const
+{
+    const std::lock_guard<std::mutex> lock(_pollingMutex);
+    return _pollingStats;
+}
+
+// Sleep until just before the deadline and spin the last part (the OS wakes up late by tens of us).
+// The sleep is an interruption point of the poll thread.
+static void waitUntil(const std::chrono::steady_clock::time_point deadline)
+{
+    constexpr auto spinMargin = std::chrono::microseconds(150);
+
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining > spinMargin)
+    {
+        const auto sleep = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining - spinMargin);
+        boost::this_thread::sleep_for(boost::chrono::nanoseconds(sleep.count()));
+    }
+
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+}
 
-        Sleep(100);
+std::chrono::microseconds FT232_MPSSE::nextPollingPeriod(const PollingConfig& config, const std::chrono::microseconds period,
+                                                         const std::chrono::steady_clock::duration idleTime) const
+{
+    if (config.mode == PollingConfig::Mode::Fixed || idleTime < config.activityHold)
+        return config.period;
+
+    // Back off while the inputs are idle
+    return std::max(config.period, std::min(period * 2, config.idlePeriod));
+}
+
+void FT232_MPSSE::updatePollingStats(const std::chrono::steady_clock::time_point now, const std::chrono::microseconds period)
+{
+    using namespace std::chrono;
+
+    if (_windowSamples > 0)
+    {
+        const auto interval = duration_cast<microseconds>(now - _lastSample);
+        const auto jitter = interval > period ? interval - period : period - interval;
+        _windowJitterSum += jitter;
+        _windowJitterMax = std::max(_windowJitterMax, jitter);
+    }
+    else
+    {
+        _windowStart = now;
+    }
+    _lastSample = now;
+    ++_windowSamples;
+
+    // Publish the statistics once per second
+    const auto window = now - _windowStart;
+    if (window < seconds(1))
+        return;
+
+    const std::lock_guard<std::mutex> lock(_pollingMutex);
+    _pollingStats.sampleRate = static_cast<double>(_windowSamples - 1) / duration<double>(window).count();
+    _pollingStats.currentPeriod = period;
+    _pollingStats.meanJitter = _windowJitterSum / static_cast<long long>(_windowSamples - 1);
+    _pollingStats.maxJitter = _windowJitterMax;
+    _pollingStats.samples += _windowSamples - 1;
+
+    // The last sample opens the next window
+    _windowStart = now;
+    _windowSamples = 1;
+    _windowJitterSum = microseconds(0);
+    _windowJitterMax = microseconds(0);
+}
+
+void FT232_MPSSE::dispatchEvents()
+{
+    while (true)
+    {
+        boost::this_thread::interruption_point();
 
-        //set speed
-        if (-1 == setSpeed(Speed::_100kbs))
+        if (_dispatchMode.load() != DispatchMode::Thread)
         {
-            closeHandle();
-            return -1;
+            // Events are consumed by the application (Manual) or not queued (Synchronous)
+            boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+            continue;
         }
 
-        clearAllPins();
+        if (!_inputEvents.notifier().wait(std::chrono::milliseconds(100)))
+            continue;
+
+        // One valueChanged per edge, with the conditioned pins state after the edge
+        _inputEvents.consume([this](const InputEvent& event)
+        {
+            edgeDetected(event);
+            valueChanged(event.pinsState);
+        });
     }
-    return 0;
 }
 
 void FT232_MPSSE::doWork()
 {
     uint16_t pinsState = 0;
+    uint16_t rawPinsState = 0;
     DeviceState state = _handle !=nullptr ? DeviceState::Ready : DeviceState::Wait;
 
+    constexpr std::chrono::milliseconds MinRetryDelay(10);
+    constexpr std::chrono::milliseconds MaxRetryDelay(2000);
+    std::chrono::milliseconds retryDelay(0);
+
+    auto period = pollingConfig().period;
+    auto nextSample = std::chrono::steady_clock::now();
+    auto lastActivity = nextSample;
+
     while (true)
     {
+        boost::this_thread::interruption_point();
+
         switch (state)
         {
         case DeviceState::Wait:
             {
-                std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
-                std::chrono::steady_clock::time_point endTime = startTime + std::chrono::seconds(2);
-                while (_handle == nullptr)
+                // The first opening is done by the constructor
+                state = _handle != nullptr ? DeviceState::Ready : DeviceState::NotReady;
+                if (state == DeviceState::Ready)
                 {
-                    if (std::chrono::steady_clock::now() >= endTime) {
-                        state = DeviceState::NotReady;
-                        break; // Break the loop if 2 seconds have passed
-                    }
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    std::cout << "\t\t\t\t\t\t(-- I am Ready --)" << std::endl;
                 }
-                state = DeviceState::Ready;
-                std::cout << "\t\t\t\t\t\t(-- I am Ready --)" << std::endl;
             }
             break;
             case DeviceState::NotReady:
                 {
-                    Sleep(1000);
+                    // Immediate first retry, then a bounded exponential backoff
+                    if (retryDelay.count() > 0)
+                    {
+                        boost::this_thread::sleep_for(boost::chrono::milliseconds(retryDelay.count()));
+                    }
+
                     if(!init())
                     {
                         std::cout << "\t\t\t\t\t\t(-- I am Ready --)" << std::endl;
                         state = DeviceState::Ready;
+                        _reconnects.fetch_add(1, std::memory_order_relaxed);
+                        retryDelay = std::chrono::milliseconds(0);
+                        nextSample = std::chrono::steady_clock::now();
+                    }
+                    else
+                    {
+                        _retries.fetch_add(1, std::memory_order_relaxed);
+                        retryDelay = std::clamp(retryDelay * 2, MinRetryDelay, MaxRetryDelay);
                     }
                 }
             break;
             case DeviceState::Ready:
                 {
-                    Sleep(200);
+                    nextSample += period;
+                    waitUntil(nextSample);
+
+                    const auto now = std::chrono::steady_clock::now();
+                    if (now - nextSample > period)
+                    {
+                        // Late by more than a period: restart the schedule instead of bursting
+                        nextSample = now;
+                    }
+                    updatePollingStats(now, period);
+                    _pollIterations.fetch_add(1, std::memory_order_relaxed);
+                    const auto config = pollingConfig();
+
                     if (_handle != nullptr)
                     {
                         if (getPinsState(pinsState))
                         {
-                            bool done = false;
-                            for (const auto& [pinNumber, pinMode] : _pinsMode)
+                            const auto inputs = inputMask();
+
+                            // Raw activity (bounces included) keeps the adaptive polling fast
+                            if ((pinsState ^ rawPinsState) & inputs)
+                            {
+                                lastActivity = now;
+                            }
+                            rawPinsState = pinsState;
+
+                            // Only the conditioned edges of the input pins are notified, a sample weighs at
+                            // most the active period in the debounce (the idle samples are far apart)
+                            const auto edges = _conditioner.process(pinsState, inputs, now, config.period, _events);
+                            if (_dispatchMode.load() == DispatchMode::Synchronous)
                             {
-                                if (pinMode == PinMode::Input)
+                                for (size_t edge = 0; edge < edges; ++edge)
+                                {
+                                    edgeDetected(_events[edge]);
+                                }
+                                if (edges > 0)
                                 {
-                                    if (Bitwise::getBitState(pinsState, static_cast<int>(pinNumber)) != Bitwise::getBitState(
-                                        _previousPinsState, static_cast<int>(pinNumber)))
-                                    {
-                                        _previousPinsState = pinsState;
-                                        done = true;
-                                    }
+                                    _previousPinsState = _conditioner.state();
+                                    valueChanged(_previousPinsState);
                                 }
                             }
-                            if (done)
+                            else
                             {
-                                valueChanged(pinsState);
+                                // Never wait for the observers on the poll thread
+                                for (size_t edge = 0; edge < edges; ++edge)
+                                {
+                                    _inputEvents.push(_events[edge]);
+                                }
                             }
                         }
-                        else if(nullptr == _handle)
-                        {
-                            state = DeviceState::NotReady;
-                        }
                     }
+
+                    if (nullptr == _handle)
+                    {
+                        // Disconnected: the API calls fail fast until the channel is reopened
+                        state = DeviceState::NotReady;
+                        continue;
+                    }
+
+                    period = nextPollingPeriod(config, period, now - lastActivity);
                 }
                 break;
         }
@@ -58,14 +58,25 @@
 
 #pragma once
 
-#include <map>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <boost/thread.hpp>
+#include <mutex>
 #include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "I2C.h"
-#include "libftd2xx/ftd2xx.h"
 
+#include "EventQueue.h"
+#include "Ft232Transport.h"
+#include "InputConditioner.h"
+#include "IoExecutor.h"
+#include "Metrics.h"
+#include "MpsseCommandBuffer.h"
+#include "Waveform.h"
 #include "inout.h"
 #include "export.h"
 
@@ -75,7 +86,125 @@ namespace IoAdapter
     class IO_ADAPTER_API FT232_MPSSE final : public io::inOut, public I2C::I2CMaster
     {
     public:
+        /**
+         * @brief Input pins polling configuration.
+         *
+         * Fixed: the pins are sampled every 'period'.
+         * Adaptive: the pins are sampled every 'period' while inputs are changing, once no change was seen
+         *           during 'activityHold' the period is doubled at each sample up to 'idlePeriod'.
+         * The poll thread sleeps until ~150 us before each sample and spins the rest (sub-ms periods stay accurate).
+         */
+        struct PollingConfig
+        {
+            enum class Mode
+            {
+                Fixed,
+                Adaptive
+            };
+
+            Mode mode = Mode::Fixed;
+            std::chrono::microseconds period{ 200000 };
+            std::chrono::microseconds idlePeriod{ 200000 };
+            std::chrono::milliseconds activityHold{ 1000 };
+        };
+
+        /**
+         * @brief Where the input events (valueChanged & edgeDetected) are delivered.
+         *
+         * Synchronous: the observers are called by the poll thread.
+         * Thread: the events are queued and the observers are called by a dispatcher thread (default).
+         * Manual: the events are only queued, the application consumes inputEvents() from its own loop
+         *         (see EventNotifier::nativeHandle()).
+         */
+        enum class DispatchMode
+        {
+            Synchronous,
+            Thread,
+            Manual
+        };
+
+        using InputEventQueue = EventQueue<InputEvent, 256>;
+
+        /**
+         * @brief Achieved polling statistics over the last second.
+         */
+        struct PollingStats
+        {
+            double sampleRate = 0;                       // Samples per second
+            std::chrono::microseconds currentPeriod{ 0 };// Period currently requested
+            std::chrono::microseconds meanJitter{ 0 };   // Mean deviation between the achieved and requested period
+            std::chrono::microseconds maxJitter{ 0 };    // Worst deviation between the achieved and requested period
+            uint64_t samples = 0;                        // Total number of samples since the start
+        };
+
+        /**
+         * @brief Channel of an FTDI MPSSE device (FT232H, FT2232H & FT4232H channels A/B).
+         */
+        struct ChannelInfo
+        {
+            uint32_t index = 0;     // libMPSSE channel index
+            uint32_t flags = 0;
+            uint32_t type = 0;
+            uint32_t id = 0;
+            uint32_t locationId = 0;
+            std::string serialNumber;
+            std::string description;
+            bool opened = false;    // Already opened by a process
+        };
+
+        /**
+         * @brief Selects the channel opened by the adapter.
+         */
+        struct ChannelSelector
+        {
+            enum class By
+            {
+                Index,
+                SerialNumber,
+                Description,
+                Location
+            };
+
+            By by = By::Index;
+            uint32_t index = 0;     // By::Index
+            std::string value;      // By::SerialNumber / By::Description
+            uint32_t locationId = 0;// By::Location
+
+            static ChannelSelector byIndex(uint32_t index);
+            static ChannelSelector bySerialNumber(const std::string& serialNumber);
+            static ChannelSelector byDescription(const std::string& description);
+            static ChannelSelector byLocation(uint32_t locationId);
+
+            bool matches(const ChannelInfo& channel) const;
+        };
+
+        /**
+         * @brief Adapter metrics since the construction (see Metrics.h).
+         */
+        struct MetricsSnapshot
+        {
+            OperationSnapshot write;        // FT_Write (GPIO & MPSSE commands)
+            OperationSnapshot read;         // FT_Read (MPSSE answers)
+            OperationSnapshot deviceWrite;  // I2C_DeviceWrite
+            OperationSnapshot deviceRead;   // I2C_DeviceRead
+            uint64_t retries = 0;           // Failed reopenings
+            uint64_t reconnects = 0;        // Successful reopenings
+            uint64_t pollIterations = 0;    // Input samples of the poll thread
+        };
+
+        /**
+         * @brief How the channel is looked up when opened.
+         */
+        enum class OpenMode
+        {
+            Enumerate,  // List and print every channel, then open the first one matching the selector
+            Fast        // Open the selected channel directly, reconnections use the cached serial number
+        };
+
         FT232_MPSSE();
+        explicit FT232_MPSSE(const ChannelSelector& selector);
+        FT232_MPSSE(const ChannelSelector& selector, OpenMode mode);
+        FT232_MPSSE(const ChannelSelector& selector, OpenMode mode, std::shared_ptr<Ft232Transport> transport);
         // Delete the default copy constructor
         FT232_MPSSE(const FT232_MPSSE&) = delete;
         FT232_MPSSE& operator=(const FT232_MPSSE&) = delete;
@@ -84,16 +213,142 @@ namespace IoAdapter
         FT232_MPSSE& operator=(FT232_MPSSE&&) = delete;
         ~FT232_MPSSE() override;
 
+        /**
+         * @brief Get the transport of the physical adapters: libftd2xx / libMPSSE in the builds with the FTDI
+         *        libraries (IO_ADAPTER_FTDI), the simulated FT232H otherwise (no hardware access).
+         *
+         * @return A new transport.
+         */
+        static std::shared_ptr<Ft232Transport> defaultTransport();
+
+        /**
+         * @brief List the MPSSE channels connected to the host.
+         *
+         * @return The channels.
+         */
+        static std::vector<ChannelInfo> enumerate();
+
+        /**
+         * @brief List the MPSSE channels of a transport.
+         *
+         * @param transport The transport (physical or simulated adapters).
+         * @return The channels.
+         */
+        static std::vector<ChannelInfo> enumerate(Ft232Transport& transport);
+
+        /**
+         * @brief Get the opened channel.
+         *
+         * @return The channel information (valid once opened).
+         */
+        ChannelInfo channel() const;
+
+        bool isOpen() const { return _handle != nullptr; }
+
+        /**
+         * @brief Get the time from the construction to the first I/O on the channel.
+         *
+         * @return The startup time, zero until the channel is opened.
+         */
+        std::chrono::microseconds startupTime() const;
+
+        /**
+         * @brief Get the adapter metrics, can be called at any time without stopping the I/O.
+         *
+         * @return The latencies & counters since the construction.
+         */
+        MetricsSnapshot metrics() const;
+
         //IO interface
         bool pinMode(Gpio gpio, const PinMode mode) override;
         bool set(Gpio, GpioState) override;
         bool get(Gpio, GpioState&) override;
+        bool pinsMode(Port port, uint8_t mask, PinMode mode) override;
+        bool writePort(Port port, uint8_t value, uint8_t mask = 0xFF) override;
+        bool readPort(Port port, uint8_t& value) override;
+        bool getPinsState(uint16_t& pinsState) override;
+
+        /**
+         * @brief Open a batch: the GPIO writes of the calling thread are queued and sent together in one USB
+         *        transfer by endBatch() (or with the next read). Batches can be nested, one thread at a time
+         *        owns the batch: the writes of the other threads aren't deferred.
+         */
+        void beginBatch();
+
+        /**
+         * @brief Close a batch, the outermost one sends the queued GPIO writes.
+         *
+         * @return True if successful, false otherwise.
+         */
+        bool endBatch();
+
+        // RAII batch
+        class ScopedBatch
+        {
+        public:
+            explicit ScopedBatch(FT232_MPSSE& device) : _device(device) { _device.beginBatch(); }
+            ScopedBatch(const ScopedBatch&) = delete;
+            ScopedBatch& operator=(const ScopedBatch&) = delete;
+            ~ScopedBatch() { _device.endBatch(); }
+
+        private:
+            FT232_MPSSE& _device;
+        };
+
+        /**
+         * @brief Play a pulse train on the GPIO pins, timed by the MPSSE clock (see Waveform.h).
+         *
+         * @param waveform The pulse train, its pins have to be configured as outputs.
+         * @return True if successful, false otherwise.
+         */
+        bool playWaveform(const Waveform& waveform);
+
+        /**
+         * @brief Get the waveform timing resolution (one MPSSE clock, depends on the I2C speed).
+         *
+         * @return The duration of one clock.
+         */
+        std::chrono::nanoseconds waveformResolution() const;
 
-        //I2C interface
+        //I2C interface (FastBytes transfers by default)
         int setSpeed(I2CMaster::Speed speed) override;
+        int getSpeed(I2CMaster::Speed& speed) const override;
+        int setTransferMode(TransferMode mode) override;
+        TransferMode transferMode() const override;
+        int read(uint8_t addr, uint8_t* buf, size_t len) override;
+        int write(uint8_t addr, const uint8_t* buf, size_t len) override;
+        int writeRead(uint8_t addr, const uint8_t* out, size_t outLen, uint8_t* in, size_t inLen) override;
+        int read(uint8_t addr, uint8_t* buf, size_t len, const Transfer& transfer) override;
+        int write(uint8_t addr, const uint8_t* buf, size_t len, const Transfer& transfer) override;
+        int writeRead(uint8_t addr, const uint8_t* out, size_t outLen, uint8_t* in, size_t inLen, const Transfer& transfer) override;
         int readWord(uint8_t addr, uint8_t cmd, uint16_t& value) override;
         int writeWord(uint8_t addr, uint8_t cmd, uint16_t value) override;
 
+        /*
+         * Asynchronous API: the requests are executed by the adapter owner thread, the requests queued at the
+         * same time are pipelined (the GPIO writes share one USB transfer).
+         * Use executor().submit(request, completion) for a completion callback instead of a future.
+         */
+        std::future<bool> setAsync(Gpio gpio, GpioState state);
+        std::future<GpioState> getAsync(Gpio gpio);// GpioState::Unknown on error
+        std::future<bool> writePortAsync(Port port, uint8_t value, uint8_t mask = 0xFF);
+        std::future<int> readWordAsync(uint8_t addr, uint8_t cmd);// The word or -1 on error
+        std::future<int> writeWordAsync(uint8_t addr, uint8_t cmd, uint16_t value);// 0 or -1 on error
+        IoExecutor& executor() { return _executor; }
+
+        //Input polling
+        void setPollingConfig(const PollingConfig& config);
+        PollingConfig pollingConfig() const;
+        PollingStats pollingStats() const;
+
+        //Input conditioning (debounce & edges selection of the input pins)
+        InputConditioner& inputConditioner() { return _conditioner; }
+
+        //Input events delivery
+        void setDispatchMode(DispatchMode mode) { _dispatchMode.store(mode); }
+        DispatchMode dispatchMode() const { return _dispatchMode.load(); }
+        InputEventQueue& inputEvents() { return _inputEvents; }
+
     private:
         enum class DeviceState
         {
@@ -102,43 +357,81 @@ namespace IoAdapter
             Wait
         };
         void doWork();
+        void dispatchEvents();
         int init();
-        int openCahnnel(const DWORD channelIndex);
+        int openCahnnel(const uint32_t channelIndex, Ft232Transport::Handle& handle);
+        int openDirect(Ft232Transport::Handle& handle, ChannelInfo& channel);
+        int openEnumerated(Ft232Transport::Handle& handle, ChannelInfo& channel);
+        int configureChannel(Ft232Transport::Handle handle, I2CMaster::Speed speed);
+        bool restorePins();
+        void printChannels(const std::vector<ChannelInfo>& channels) const;
         void closeHandle();
         bool clearAllPins();
-        bool readAllPins(uint8_t cmd, uint8_t& result);
-        bool getPinsState(uint16_t& pinsState);
-        bool writeToDevice(uint8_t *buffer, DWORD bytesToTransfer, DWORD& bytesTransfered);
-
-        std::map<Gpio, PinMode> _pinsMode = {
-                                                 {Gpio::D0, PinMode::Sf}, {Gpio::D1, PinMode::Sf},
-                                                 {Gpio::D2, PinMode::Sf}, {Gpio::D3, PinMode::Sf},
-                                                 {Gpio::D4, PinMode::Output}, {Gpio::D5, PinMode::Output},
-                                                 {Gpio::D6, PinMode::Output}, {Gpio::D7, PinMode::Output},
-                                                 {Gpio::C0, PinMode::Output}, {Gpio::C1, PinMode::Output},
-                                                 {Gpio::C2, PinMode::Output}, {Gpio::C3, PinMode::Output},
-                                                 {Gpio::C4, PinMode::Output}, {Gpio::C5, PinMode::Output},
-                                                 {Gpio::C6, PinMode::Output}, {Gpio::C7, PinMode::Output},
-                                                 {Gpio::C8, PinMode::Output}, {Gpio::C9, PinMode::Output}
-        };
+        bool beginTransaction();
+        int deviceWrite(uint8_t addr, const uint8_t* buffer, uint32_t size, uint32_t options);
+        int deviceRead(uint8_t addr, uint8_t* buffer, uint32_t size, uint32_t options);
+        uint32_t transferOptions(const Transfer& transfer) const;
+        bool writeToDevice(uint8_t *buffer, uint32_t bytesToTransfer, uint32_t& bytesTransfered);
+        bool readFromDevice(uint8_t *buffer, uint32_t bytesToTransfer, uint32_t& bytesTransfered);
+        bool reserveCommands(size_t bytes);
+        bool flushCommands(uint8_t* response, size_t responseSize);
+        bool writePortCommand(Port port, uint16_t values, uint16_t directions);
+        bool batching() const;
+        uint16_t inputMask() const;
+        std::chrono::microseconds nextPollingPeriod(const PollingConfig& config, std::chrono::microseconds period,
+                                                    std::chrono::steady_clock::duration idleTime) const;
+        void updatePollingStats(std::chrono::steady_clock::time_point now, std::chrono::microseconds period);
 
-        std::map<Gpio, GpioState> _pinsState = {
-                                                 {Gpio::D0, GpioState::Unknown}, {Gpio::D1, GpioState::Unknown},
-                                                 {Gpio::D2, GpioState::Unknown}, {Gpio::D3, GpioState::Unknown},
-                                                 {Gpio::D4, GpioState::Low}, {Gpio::D5, GpioState::Low},
-                                                 {Gpio::D6, GpioState::Low}, {Gpio::D7, GpioState::Low},
-                                                 {Gpio::C0, GpioState::Low}, {Gpio::C1, GpioState::Low},
-                                                 {Gpio::C2, GpioState::Low}, {Gpio::C3, GpioState::Low},
-                                                 {Gpio::C4, GpioState::Low}, {Gpio::C5, GpioState::Low},
-                                                 {Gpio::C6, GpioState::Low}, {Gpio::C7, GpioState::Low},
-                                                 {Gpio::C8, GpioState::Low}, {Gpio::C9, GpioState::Low}
-        };
+        // Packed shadow registers of the GPIO pins (bit n --> Gpio n : D0:D7 low byte, C0:C7 high byte)
+        std::atomic<uint16_t> _directions{ 0xFFF0 };      // 1: Output, 0: Input
+        std::atomic<uint16_t> _values{ 0x0000 };          // 1: High, 0: Low
+        std::atomic<uint16_t> _specialFunctions{ 0x000F };// 1: Special function (D0:D3 are used by the i2c)
 
-        uint8_t _dir{};// b0: Input , b1:  Output
-        FT_HANDLE _handle;
+        const std::shared_ptr<Ft232Transport> _transport;
+        std::atomic<Ft232Transport::Handle> _handle;
+        std::atomic<I2CMaster::Speed> _speed{ I2CMaster::Speed::_100kbs };
+        std::atomic<TransferMode> _transferMode{ TransferMode::FastBytes };
+        const ChannelSelector _selector;
+        const OpenMode _openMode;
+        ChannelInfo _channel;
+        const std::chrono::steady_clock::time_point _created;
+        std::chrono::microseconds _startupTime{ 0 };
+        MpsseCommandBuffer _commands;
+        unsigned _batchDepth = 0;
+        std::thread::id _batchOwner;
+        std::atomic<uint32_t> _bitRate{ 100000 };// MPSSE clocked bits per second
 
-        boost::thread _thread;
         uint16_t _previousPinsState;
         mutable std::shared_mutex _mutex;
+        std::mutex _openMutex;
+
+        InputConditioner _conditioner;
+        InputConditioner::Events _events{};
+        InputEventQueue _inputEvents;
+        std::atomic<DispatchMode> _dispatchMode{ DispatchMode::Thread };
+
+        PollingConfig _pollingConfig;
+        PollingStats _pollingStats;
+        mutable std::mutex _pollingMutex;
+
+        // Poll thread only: current statistics window
+        std::chrono::steady_clock::time_point _windowStart;
+        std::chrono::steady_clock::time_point _lastSample;
+        uint64_t _windowSamples = 0;
+        std::chrono::microseconds _windowJitterSum{ 0 };
+        std::chrono::microseconds _windowJitterMax{ 0 };
+
+        OperationMetrics _writeMetrics;
+        OperationMetrics _readMetrics;
+        OperationMetrics _deviceWriteMetrics;
+        OperationMetrics _deviceReadMetrics;
+        std::atomic<uint64_t> _retries{ 0 };
+        std::atomic<uint64_t> _reconnects{ 0 };
+        std::atomic<uint64_t> _pollIterations{ 0 };
+
+        // Declared last: the threads use all the other members
+        IoExecutor _executor;
+        boost::thread _thread;
+        boost::thread _dispatcher;
     };
 }
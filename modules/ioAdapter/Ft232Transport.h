@@ -0,0 +1,132 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    USB transport of the FT232H adapters. FT232_MPSSE only talks to the chip through this interface:
+    - FtdiTransport forwards the calls to libftd2xx / libMPSSE (physical FT232H, Windows builds only).
+    - SimulatedFt232Transport runs an in-process FT232H (MPSSE GPIO opcodes, I2C slaves, USB latency model).
+      It is the default transport of the builds without the FTDI libraries (Linux).
+
+    The status codes, transfer options and clock rates keep the libftd2xx / libMPSSE values so the
+    FTDI implementation forwards them unchanged.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API Ft232Transport
+    {
+    public:
+        using Handle = void*;
+        using Status = uint32_t;
+
+        // FT_STATUS values
+        static constexpr Status Ok = 0;
+        static constexpr Status InvalidHandle = 1;
+        static constexpr Status DeviceNotFound = 2;
+        static constexpr Status DeviceNotOpened = 3;
+        static constexpr Status IoError = 4;
+        static constexpr Status InvalidParameter = 6;
+
+        // I2C_TRANSFER_OPTIONS_* values
+        static constexpr uint32_t TransferStartBit = 0x01;
+        static constexpr uint32_t TransferStopBit = 0x02;
+        static constexpr uint32_t TransferBreakOnNack = 0x04;
+        static constexpr uint32_t TransferNackLastByte = 0x08;
+        static constexpr uint32_t TransferFastBytes = 0x10;
+        static constexpr uint32_t TransferFastBits = 0x20;
+        static constexpr uint32_t TransferNoAddress = 0x40;
+
+        // I2C_CLOCKRATE values (Hz)
+        static constexpr uint32_t ClockStandardMode = 100000;
+        static constexpr uint32_t ClockFastMode = 400000;
+        static constexpr uint32_t ClockFastModePlus = 1000000;
+        static constexpr uint32_t ClockHighSpeedMode = 3400000;
+
+        // ChannelConfig.Options values
+        static constexpr uint32_t ChannelPinStateConfig = 0x10;
+
+        /**
+         * @brief Channel as listed by the driver (FT_DEVICE_LIST_INFO_NODE).
+         */
+        struct DeviceInfo
+        {
+            uint32_t flags = 0;
+            uint32_t type = 0;
+            uint32_t id = 0;
+            uint32_t locationId = 0;
+            std::string serialNumber;
+            std::string description;
+        };
+
+        /**
+         * @brief I2C channel configuration (libMPSSE ChannelConfig).
+         */
+        struct ChannelConfig
+        {
+            uint32_t clockRate = ClockStandardMode;
+            uint8_t latencyTimer = 16;
+            uint32_t options = 0;
+            uint32_t pin = 0;   // BIT7-0: initial direction, BIT15-8: initial values, BIT23-16: final direction, BIT31-24: final values
+        };
+
+        enum class OpenBy
+        {
+            SerialNumber,
+            Description,
+            Location
+        };
+
+        virtual ~Ft232Transport() = default;
+
+        /**
+         * @brief Reference the driver, the first user initializes it.
+         */
+        virtual void acquire() = 0;
+
+        /**
+         * @brief Release the driver, the last user cleans it up.
+         */
+        virtual void release() = 0;
+
+        virtual Status getNumChannels(uint32_t& count) = 0;
+        virtual Status getChannelInfo(uint32_t index, DeviceInfo& info) = 0;
+
+        /**
+         * @brief Open a channel by its libMPSSE index (I2C_OpenChannel).
+         */
+        virtual Status openChannel(uint32_t index, Handle& handle) = 0;
+
+        /**
+         * @brief Open a channel without listing the connected ones (FT_OpenEx).
+         *
+         * @param by The identification used.
+         * @param value The serial number or description.
+         * @param locationId The location (OpenBy::Location).
+         * @param handle The opened handle.
+         */
+        virtual Status openEx(OpenBy by, const std::string& value, uint32_t locationId, Handle& handle) = 0;
+
+        virtual Status getDeviceInfo(Handle handle, DeviceInfo& info) = 0;
+        virtual Status initChannel(Handle handle, const ChannelConfig& config) = 0;
+        virtual Status closeChannel(Handle handle) = 0;
+
+        // Raw MPSSE commands & answers (FT_Write / FT_Read)
+        virtual Status write(Handle handle, const uint8_t* buffer, uint32_t size, uint32_t& written) = 0;
+        virtual Status read(Handle handle, uint8_t* buffer, uint32_t size, uint32_t& received) = 0;
+
+        // I2C transactions (I2C_DeviceWrite / I2C_DeviceRead)
+        virtual Status deviceWrite(Handle handle, uint8_t address, const uint8_t* buffer, uint32_t size,
+                                   uint32_t& transferred, uint32_t options) = 0;
+        virtual Status deviceRead(Handle handle, uint8_t address, uint8_t* buffer, uint32_t size,
+                                  uint32_t& transferred, uint32_t options) = 0;
+    };
+}
@@ -0,0 +1,168 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "FtdiTransport.h"
+
+#include <cstdint>
+#include <mutex>
+
+#include "libftd2xx/ftd2xx.h"
+#include "libmpsse_i2c.h"
+
+using namespace IoAdapter;
+
+static_assert(Ft232Transport::Ok == FT_OK, "FT_STATUS values are forwarded unchanged");
+static_assert(Ft232Transport::IoError == FT_IO_ERROR, "FT_STATUS values are forwarded unchanged");
+static_assert(Ft232Transport::TransferStartBit == I2C_TRANSFER_OPTIONS_START_BIT &&
+              Ft232Transport::TransferStopBit == I2C_TRANSFER_OPTIONS_STOP_BIT &&
+              Ft232Transport::TransferBreakOnNack == I2C_TRANSFER_OPTIONS_BREAK_ON_NACK &&
+              Ft232Transport::TransferNackLastByte == I2C_TRANSFER_OPTIONS_NACK_LAST_BYTE &&
+              Ft232Transport::TransferFastBytes == I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BYTES &&
+              Ft232Transport::TransferFastBits == I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BITS &&
+              Ft232Transport::TransferNoAddress == I2C_TRANSFER_OPTIONS_NO_ADDRESS,
+              "I2C transfer options are forwarded unchanged");
+
+// libMPSSE is shared by all the adapters: initialized by the first one and cleaned up by the last one
+static std::mutex LibraryMutex;
+static unsigned LibraryUsers = 0;
+
+void FtdiTransport::acquire()
+{
+    const std::lock_guard<std::mutex> lock(LibraryMutex);
+    if (LibraryUsers++ == 0)
+    {
+        Init_libMPSSE();
+    }
+}
+
+void FtdiTransport::release()
+{
+    const std::lock_guard<std::mutex> lock(LibraryMutex);
+    if (--LibraryUsers == 0)
+    {
+        Cleanup_libMPSSE();
+    }
+}
+
+Ft232Transport::Status FtdiTransport::getNumChannels(uint32_t& count)
+{
+    DWORD channels = 0;
+    const FT_STATUS status = I2C_GetNumChannels(&channels);
+    count = static_cast<uint32_t>(channels);
+    return static_cast<Status>(status);
+}
+
+Ft232Transport::Status FtdiTransport::getChannelInfo(const uint32_t index, DeviceInfo& info)
+{
+    FT_DEVICE_LIST_INFO_NODE devList;
+    const FT_STATUS status = I2C_GetChannelInfo(index, &devList);
+    if (status != FT_OK)
+        return static_cast<Status>(status);
+
+    info.flags = static_cast<uint32_t>(devList.Flags);
+    info.type = static_cast<uint32_t>(devList.Type);
+    info.id = static_cast<uint32_t>(devList.ID);
+    info.locationId = static_cast<uint32_t>(devList.LocId);
+    info.serialNumber = devList.SerialNumber;
+    info.description = devList.Description;
+    return Ok;
+}
+
+Ft232Transport::Status FtdiTransport::openChannel(const uint32_t index, Handle& handle)
+{
+    FT_HANDLE ftHandle = nullptr;
+    const FT_STATUS status = I2C_OpenChannel(index, &ftHandle);
+    handle = ftHandle;
+    return static_cast<Status>(status);
+}
+
+Ft232Transport::Status FtdiTransport::openEx(const OpenBy by, const std::string& value, const uint32_t locationId, Handle& handle)
+{
+    FT_HANDLE ftHandle = nullptr;
+    FT_STATUS status;
+    switch (by)
+    {
+    case OpenBy::Description:
+        status = FT_OpenEx(const_cast<char*>(value.c_str()), FT_OPEN_BY_DESCRIPTION, &ftHandle);
+        break;
+    case OpenBy::Location:
+        status = FT_OpenEx(reinterpret_cast<void*>(static_cast<uintptr_t>(locationId)), FT_OPEN_BY_LOCATION, &ftHandle);
+        break;
+    case OpenBy::SerialNumber:
+    default:
+        status = FT_OpenEx(const_cast<char*>(value.c_str()), FT_OPEN_BY_SERIAL_NUMBER, &ftHandle);
+        break;
+    }
+    handle = ftHandle;
+    return static_cast<Status>(status);
+}
+
+Ft232Transport::Status FtdiTransport::getDeviceInfo(Handle handle, DeviceInfo& info)
+{
+    FT_DEVICE type = 0;
+    DWORD id = 0;
+    char serialNumber[16] = {};
+    char description[64] = {};
+    const FT_STATUS status = FT_GetDeviceInfo(handle, &type, &id, serialNumber, description, nullptr);
+    if (status != FT_OK)
+        return static_cast<Status>(status);
+
+    info.type = static_cast<uint32_t>(type);
+    info.id = static_cast<uint32_t>(id);
+    info.serialNumber = serialNumber;
+    info.description = description;
+    return Ok;
+}
+
+Ft232Transport::Status FtdiTransport::initChannel(Handle handle, const ChannelConfig& config)
+{
+    ChannelConfig_t channelConf;
+    channelConf.ClockRate = static_cast<I2C_CLOCKRATE>(config.clockRate);
+    channelConf.LatencyTimer = config.latencyTimer;
+    channelConf.Options = config.options;
+    channelConf.Pin = config.pin;
+    channelConf.currentPinState = 0; // Current pin status (not used for I2C)
+    return static_cast<Status>(I2C_InitChannel(handle, &channelConf));
+}
+
+Ft232Transport::Status FtdiTransport::closeChannel(Handle handle)
+{
+    return static_cast<Status>(I2C_CloseChannel(handle));
+}
+
+Ft232Transport::Status FtdiTransport::write(Handle handle, const uint8_t* buffer, const uint32_t size, uint32_t& written)
+{
+    DWORD bytesWritten = 0;
+    const FT_STATUS status = FT_Write(handle, const_cast<uint8_t*>(buffer), size, &bytesWritten);
+    written = static_cast<uint32_t>(bytesWritten);
+    return static_cast<Status>(status);
+}
+
+Ft232Transport::Status FtdiTransport::read(Handle handle, uint8_t* buffer, const uint32_t size, uint32_t& received)
+{
+    DWORD bytesReceived = 0;
+    const FT_STATUS status = FT_Read(handle, buffer, size, &bytesReceived);
+    received = static_cast<uint32_t>(bytesReceived);
+    return static_cast<Status>(status);
+}
+
+Ft232Transport::Status FtdiTransport::deviceWrite(Handle handle, const uint8_t address, const uint8_t* buffer, const uint32_t size,
+                                                  uint32_t& transferred, const uint32_t options)
+{
+    DWORD bytesTransferred = 0;
+    const FT_STATUS status = I2C_DeviceWrite(handle, address, size, const_cast<uint8_t*>(buffer), &bytesTransferred, options);
+    transferred = static_cast<uint32_t>(bytesTransferred);
+    return static_cast<Status>(status);
+}
+
+Ft232Transport::Status FtdiTransport::deviceRead(Handle handle, const uint8_t address, uint8_t* buffer, const uint32_t size,
+                                                 uint32_t& transferred, const uint32_t options)
+{
+    DWORD bytesTransferred = 0;
+    const FT_STATUS status = I2C_DeviceRead(handle, address, size, buffer, &bytesTransferred, options);
+    transferred = static_cast<uint32_t>(bytesTransferred);
+    return static_cast<Status>(status);
+}
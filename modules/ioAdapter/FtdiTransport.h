@@ -0,0 +1,49 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    FT232H transport forwarding the calls to libftd2xx / libMPSSE (physical adapters).
+*/
+
+#pragma once
+
+#include "Ft232Transport.h"
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API FtdiTransport final : public Ft232Transport
+    {
+    public:
+        FtdiTransport() = default;
+        // Delete the default copy constructor
+        FtdiTransport(const FtdiTransport&) = delete;
+        FtdiTransport& operator=(const FtdiTransport&) = delete;
+        // Delete the default move constructor
+        FtdiTransport(FtdiTransport&&) = delete;
+        FtdiTransport& operator=(FtdiTransport&&) = delete;
+        ~FtdiTransport() override = default;
+
+        // libMPSSE is shared by all the adapters of the process
+        void acquire() override;
+        void release() override;
+
+        Status getNumChannels(uint32_t& count) override;
+        Status getChannelInfo(uint32_t index, DeviceInfo& info) override;
+        Status openChannel(uint32_t index, Handle& handle) override;
+        Status openEx(OpenBy by, const std::string& value, uint32_t locationId, Handle& handle) override;
+        Status getDeviceInfo(Handle handle, DeviceInfo& info) override;
+        Status initChannel(Handle handle, const ChannelConfig& config) override;
+        Status closeChannel(Handle handle) override;
+
+        Status write(Handle handle, const uint8_t* buffer, uint32_t size, uint32_t& written) override;
+        Status read(Handle handle, uint8_t* buffer, uint32_t size, uint32_t& received) override;
+
+        Status deviceWrite(Handle handle, uint8_t address, const uint8_t* buffer, uint32_t size,
+                           uint32_t& transferred, uint32_t options) override;
+        Status deviceRead(Handle handle, uint8_t address, uint8_t* buffer, uint32_t size,
+                          uint32_t& transferred, uint32_t options) override;
+    };
+}
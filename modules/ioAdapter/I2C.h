@@ -1,5 +1,7 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 
 namespace I2C
 {
@@ -24,6 +26,26 @@ namespace I2C
             _34mbs = 3400, /**< High-speed mode */
         };
 
+        /**
+         * @brief How the bytes of a transaction are clocked by the adapter.
+         */
+        enum class TransferMode
+        {
+            Default,    // The master default (see setTransferMode)
+            PerByte,    // One USB round trip per byte, every acknowledge checked before the next byte
+            FastBytes,  // The whole transaction in one USB transfer, the acknowledges are reported at the end
+            FastBits    // Same as FastBytes, the length is counted in bits by the adapter
+        };
+
+        /**
+         * @brief Per transaction options.
+         */
+        struct Transfer
+        {
+            TransferMode mode = TransferMode::Default;
+            bool noAddress = false;     // No address phase: the transaction continues the previous one of the slave
+        };
+
         /**
          * @brief Set the I2C/SMBus.
          *
@@ -36,6 +58,35 @@ namespace I2C
             return -1;
         }
 
+        /**
+         * @brief Get the I2C/SMBus speed.
+         *
+         * @param speed The current bus speed.
+         * @return 0 if successful, -1 otherwise.
+         */
+        virtual int getSpeed(Speed& speed) const
+        {
+            (void)speed;
+            return -1;
+        }
+
+        /**
+         * @brief Set the transfer mode of the transactions that don't choose one.
+         *
+         * @param mode The default mode (not Default).
+         * @return 0 if successful, -1 if the mode isn't supported.
+         */
+        virtual int setTransferMode(TransferMode mode)
+        {
+            (void)mode;
+            return -1;
+        }
+
+        /**
+         * @brief Get the default transfer mode (Default if the master has no choice).
+         */
+        virtual TransferMode transferMode() const { return TransferMode::Default; }
+
         // I2C - 7 bits slave address.
          /**
           * @brief Read I2C data from a slave.
@@ -55,6 +106,43 @@ namespace I2C
          * @return Number of write bytes or -1 on error.
          */
         virtual int /* ssize_t */ write(const uint8_t addr, const uint8_t* buf, const size_t len) { (void)addr; (void)buf; (void)len; return -1; }
+        /**
+         * @brief Write then read a slave in one transaction (repeated start, no stop in between).
+         *
+         * @param addr The 7 bit slave address.
+         * @param out Data bytes written first (ex: the register address).
+         * @param outLen The number of bytes to write (at least 1).
+         * @param in Data bytes read from the slave.
+         * @param inLen The number of bytes to read from the slave.
+         * @return Number of read bytes or -1 on error.
+         */
+        virtual int /* ssize_t */ writeRead(const uint8_t addr, const uint8_t* out, const size_t outLen, uint8_t* in, const size_t inLen)
+        {
+            (void)addr; (void)out; (void)outLen; (void)in; (void)inLen;
+            return -1;
+        }
+
+        /**
+         * @brief Same as read / write / writeRead with a transfer mode for this transaction only
+         *        (the noAddress option applies to the first phase of writeRead).
+         *        The masters without transfer modes ignore the options.
+         */
+        virtual int /* ssize_t */ read(const uint8_t addr, uint8_t* buf, const size_t len, const Transfer& transfer)
+        {
+            (void)transfer;
+            return read(addr, buf, len);
+        }
+        virtual int /* ssize_t */ write(const uint8_t addr, const uint8_t* buf, const size_t len, const Transfer& transfer)
+        {
+            (void)transfer;
+            return write(addr, buf, len);
+        }
+        virtual int /* ssize_t */ writeRead(const uint8_t addr, const uint8_t* out, const size_t outLen, uint8_t* in, const size_t inLen,
+                                            const Transfer& transfer)
+        {
+            (void)transfer;
+            return writeRead(addr, out, outLen, in, inLen);
+        }
 
         /**
          * @brief SMBus "read word" protocol
@@ -105,6 +193,25 @@ namespace I2C
          * @return Number of write bytes or -1 on error.
          */
         virtual /* ssize_t */ int write(const uint8_t* buf, size_t len) { return _master->write(_addr, buf, len); }
+        /**
+         * @brief Write then read the slave in one transaction (repeated start).
+         *
+         * @param out Data bytes written first.
+         * @param outLen The number of bytes to write.
+         * @param in Data bytes read from the slave.
+         * @param inLen The number of bytes to read from the slave.
+         * @return Number of read bytes or -1 on error.
+         */
+        virtual /* ssize_t */ int writeRead(const uint8_t* out, size_t outLen, uint8_t* in, size_t inLen) { return _master->writeRead(_addr, out, outLen, in, inLen); }
+        /**
+         * @brief Read consecutive registers (register address, repeated start, burst read).
+         *
+         * @param reg The first register.
+         * @param buf The registers values.
+         * @param len The number of registers.
+         * @return Number of read bytes or -1 on error.
+         */
+        /* ssize_t */ int readRegisters(uint8_t reg, uint8_t* buf, size_t len) { return writeRead(&reg, 1, buf, len); }
 
         // SMBus
         /**
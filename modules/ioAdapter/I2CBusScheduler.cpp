@@ -0,0 +1,346 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "I2CBusScheduler.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace IoAdapter;
+
+/*
+   Master handed to the slaves: every call becomes a transaction of the client class.
+ */
+class I2CBusScheduler::Client final : public I2C::I2CMaster
+{
+public:
+    Client(std::shared_ptr<I2CBusScheduler> scheduler, const Priority priority) :
+        _scheduler(std::move(scheduler)),
+        _priority(priority) {}
+
+    int setSpeed(const Speed speed) override
+    {
+        Transaction transaction;
+        transaction.operation = Operation::SetSpeed;
+        transaction.speed = speed;
+        return submit(transaction);
+    }
+
+    int getSpeed(Speed& speed) const override
+    {
+        return _scheduler->_master->getSpeed(speed);
+    }
+
+    // Client default, the master default if not set
+    int setTransferMode(const TransferMode mode) override
+    {
+        _mode = mode;
+        return 0;
+    }
+
+    TransferMode transferMode() const override
+    {
+        const auto mode = _mode.load();
+        return mode != TransferMode::Default ? mode : _scheduler->_master->transferMode();
+    }
+
+    int read(const uint8_t addr, uint8_t* buf, const size_t len) override
+    {
+        return read(addr, buf, len, Transfer{});
+    }
+
+    int write(const uint8_t addr, const uint8_t* buf, const size_t len) override
+    {
+        return write(addr, buf, len, Transfer{});
+    }
+
+    int writeRead(const uint8_t addr, const uint8_t* out, const size_t outLen, uint8_t* in, const size_t inLen) override
+    {
+        return writeRead(addr, out, outLen, in, inLen, Transfer{});
+    }
+
+    int read(const uint8_t addr, uint8_t* buf, const size_t len, const Transfer& transfer) override
+    {
+        Transaction transaction;
+        transaction.operation = Operation::Read;
+        transaction.address = addr;
+        transaction.in = buf;
+        transaction.inLength = len;
+        transaction.transfer = transfer;
+        return submit(transaction);
+    }
+
+    int write(const uint8_t addr, const uint8_t* buf, const size_t len, const Transfer& transfer) override
+    {
+        Transaction transaction;
+        transaction.operation = Operation::Write;
+        transaction.address = addr;
+        transaction.out = buf;
+        transaction.outLength = len;
+        transaction.transfer = transfer;
+        return submit(transaction);
+    }
+
+    int writeRead(const uint8_t addr, const uint8_t* out, const size_t outLen, uint8_t* in, const size_t inLen,
+                  const Transfer& transfer) override
+    {
+        Transaction transaction;
+        transaction.operation = Operation::WriteRead;
+        transaction.address = addr;
+        transaction.out = out;
+        transaction.outLength = outLen;
+        transaction.in = in;
+        transaction.inLength = inLen;
+        transaction.transfer = transfer;
+        return submit(transaction);
+    }
+
+    int readWord(const uint8_t addr, const uint8_t cmd, uint16_t& value) override
+    {
+        Transaction transaction;
+        transaction.operation = Operation::ReadWord;
+        transaction.address = addr;
+        transaction.command = cmd;
+        const auto result = submit(transaction);
+        if (result == 0)
+        {
+            value = transaction.word;
+        }
+        return result;
+    }
+
+    int writeWord(const uint8_t addr, const uint8_t cmd, const uint16_t value) override
+    {
+        Transaction transaction;
+        transaction.operation = Operation::WriteWord;
+        transaction.address = addr;
+        transaction.command = cmd;
+        transaction.word = value;
+        return submit(transaction);
+    }
+
+private:
+    int submit(Transaction& transaction) const
+    {
+        transaction.priority = _priority;
+        if (transaction.transfer.mode == TransferMode::Default)
+        {
+            transaction.transfer.mode = _mode;
+        }
+        return _scheduler->execute(transaction);
+    }
+
+    const std::shared_ptr<I2CBusScheduler> _scheduler;
+    const Priority _priority;
+    std::atomic<TransferMode> _mode{ TransferMode::Default };
+};
+
+std::shared_ptr<I2CBusScheduler> I2CBusScheduler::create(std::shared_ptr<I2C::I2CMaster> master, const Config& config)
+{
+    std::shared_ptr<I2CBusScheduler> scheduler(new I2CBusScheduler(std::move(master), config));
+    scheduler->_thread = boost::thread(&I2CBusScheduler::run, scheduler.get());
+    return scheduler;
+}
+
+std::shared_ptr<I2CBusScheduler> I2CBusScheduler::create(std::shared_ptr<I2C::I2CMaster> master)
+{
+    return create(std::move(master), Config());
+}
+
+I2CBusScheduler::I2CBusScheduler(std::shared_ptr<I2C::I2CMaster> master, const Config& config) :
+    _master(std::move(master)),
+    _config(config)
+{
+}
+
+I2CBusScheduler::~I2CBusScheduler()
+{
+    stop();
+}
+
+std::shared_ptr<I2C::I2CMaster> I2CBusScheduler::client(const Priority priority)
+{
+    return std::make_shared<Client>(shared_from_this(), priority);
+}
+
+void I2CBusScheduler::stop()
+{
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+    }
+    _condition.notify_one();
+
+    if (_thread.joinable() && _thread.get_id() != boost::this_thread::get_id())
+    {
+        _thread.join();
+    }
+}
+
+size_t I2CBusScheduler::pending() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    size_t count = 0;
+    for (const auto& queue : _queues)
+    {
+        count += queue.size();
+    }
+    return count;
+}
+
+I2CBusScheduler::Snapshot I2CBusScheduler::metrics() const
+{
+    Snapshot snapshot;
+    for (size_t priority = 0; priority < PrioritiesCount; ++priority)
+    {
+        snapshot[priority].transactions = _metrics[priority].transactions.snapshot();
+        snapshot[priority].queueWait = _metrics[priority].queueWait.snapshot();
+        snapshot[priority].promoted = _metrics[priority].promoted.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+int I2CBusScheduler::execute(Transaction& transaction)
+{
+    // A transaction issued by the bus owner thread itself (nested call) can't wait for it
+    if (_thread.get_id() == boost::this_thread::get_id())
+        return perform(transaction);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_stopped)
+        return -1;
+
+    transaction.queued = std::chrono::steady_clock::now();
+    _queues[static_cast<size_t>(transaction.priority)].push_back(&transaction);
+    _condition.notify_one();
+
+    transaction.completed.wait(lock, [&transaction]() { return transaction.done; });
+    return transaction.result;
+}
+
+int I2CBusScheduler::perform(Transaction& transaction)
+{
+    switch (transaction.operation)
+    {
+    case Operation::Read:
+        return _master->read(transaction.address, transaction.in, transaction.inLength, transaction.transfer);
+    case Operation::Write:
+        return _master->write(transaction.address, transaction.out, transaction.outLength, transaction.transfer);
+    case Operation::WriteRead:
+        return _master->writeRead(transaction.address, transaction.out, transaction.outLength, transaction.in, transaction.inLength,
+                                  transaction.transfer);
+    case Operation::ReadWord:
+        return _master->readWord(transaction.address, transaction.command, transaction.word);
+    case Operation::WriteWord:
+        return _master->writeWord(transaction.address, transaction.command, transaction.word);
+    case Operation::SetSpeed:
+        return _master->setSpeed(transaction.speed);
+    }
+    return -1;
+}
+
+/*
+   Pick the next transaction, the caller must hold _mutex.
+   The queue fronts are the oldest transactions of their class: a Normal / Background front goes up one
+   class per agingPeriod waited (never up to RealTime), the lowest effective class wins, the oldest on a tie.
+   After realTimeBurst RealTime transactions in a row, the best other front is served if it waited at least
+   agingPeriod (bounded share of the bus under a steady RealTime load).
+ */
+I2CBusScheduler::Transaction* I2CBusScheduler::next(const std::chrono::steady_clock::time_point now)
+{
+    constexpr auto realTime = static_cast<size_t>(Priority::RealTime);
+    constexpr auto lowestPromoted = static_cast<size_t>(Priority::Normal);
+
+    size_t best = PrioritiesCount;
+    size_t bestRank = PrioritiesCount;
+    size_t other = PrioritiesCount;     // Best front of the other classes
+    size_t otherRank = PrioritiesCount;
+    for (size_t priority = 0; priority < PrioritiesCount; ++priority)
+    {
+        if (_queues[priority].empty())
+            continue;
+
+        size_t rank = priority;
+        if (priority > lowestPromoted && _config.agingPeriod.count() > 0)
+        {
+            const auto periods = static_cast<size_t>((now - _queues[priority].front()->queued) / _config.agingPeriod);
+            rank = std::max(lowestPromoted, priority - std::min(priority, periods));
+        }
+
+        auto better = [&](const size_t current, const size_t currentRank)
+        {
+            return rank < currentRank ||
+                   (rank == currentRank && _queues[priority].front()->queued < _queues[current].front()->queued);
+        };
+        if (better(best, bestRank))
+        {
+            best = priority;
+            bestRank = rank;
+        }
+        if (priority != realTime && better(other, otherRank))
+        {
+            other = priority;
+            otherRank = rank;
+        }
+    }
+
+    if (best == PrioritiesCount)
+        return nullptr;
+
+    if (best == realTime && other != PrioritiesCount && _config.realTimeBurst > 0 &&
+        _realTimeStreak >= _config.realTimeBurst && now - _queues[other].front()->queued >= _config.agingPeriod)
+    {
+        best = other;
+        bestRank = realTime;
+    }
+    _realTimeStreak = best == realTime ? _realTimeStreak + 1 : 0;
+
+    if (bestRank < best)
+    {
+        _metrics[best].promoted.fetch_add(1, std::memory_order_relaxed);
+    }
+    const auto transaction = _queues[best].front();
+    _queues[best].pop_front();
+    return transaction;
+}
+
+void I2CBusScheduler::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _condition.wait(lock, [this]()
+        {
+            return _stopped || std::any_of(_queues.begin(), _queues.end(), [](const auto& queue) { return !queue.empty(); });
+        });
+
+        // Back-to-back until the queues are empty, the choice is made again after every transaction
+        auto start = std::chrono::steady_clock::now();
+        Transaction* transaction = next(start);
+        if (transaction == nullptr)
+            return;// Stopped & drained
+
+        while (transaction != nullptr)
+        {
+            lock.unlock();
+            const auto result = perform(*transaction);
+            const auto end = std::chrono::steady_clock::now();
+
+            auto& metrics = _metrics[static_cast<size_t>(transaction->priority)];
+            metrics.queueWait.record(start - transaction->queued);
+            metrics.transactions.record(end - transaction->queued, result >= 0,
+                                        result > 0 ? static_cast<uint64_t>(result) : 0);
+
+            lock.lock();
+            transaction->result = result;
+            transaction->done = true;
+            transaction->completed.notify_one();
+
+            start = end;
+            transaction = next(start);
+        }
+    }
+}
@@ -0,0 +1,173 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Arbiter of an I2C bus shared by several slaves. Each slave is given a client master of a priority class
+    instead of the real master: its transactions are queued and executed back-to-back by the bus owner
+    thread, the most urgent class first, FIFO inside a class. The callers still block until their
+    transaction is done (same I2CMaster interface, no allocation per transaction).
+
+    Latency:
+    - RealTime: a RealTime transaction waits at most for the transaction in progress, the RealTime
+      transactions queued before it and one aged transaction per realTimeBurst RealTime ones.
+    - Normal / Background: a transaction waiting longer than agingPeriod is served as the next class up
+      (one step per period, up to Normal). Once one has waited agingPeriod, it gets the bus after at most
+      realTimeBurst RealTime transactions in a row: a steady RealTime load can't starve the other classes,
+      the servo updates keep most of the bus. Keep the Background transactions short, a long read delays
+      the next RealTime one.
+
+    Exemple:
+    const auto scheduler = I2CBusScheduler::create(device);
+    PCA9685 servos(scheduler->client(I2CBusScheduler::Priority::RealTime), 0x40);
+    Sensor sensor(scheduler->client(I2CBusScheduler::Priority::Background), 0x48);
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include <boost/thread.hpp>
+
+#include "I2C.h"
+#include "Metrics.h"
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API I2CBusScheduler final : public std::enable_shared_from_this<I2CBusScheduler>
+    {
+    public:
+        enum class Priority
+        {
+            RealTime,       // Servo / actuator updates
+            Normal,
+            Background      // Sensor polling, diagnostics
+        };
+
+        static constexpr size_t PrioritiesCount = 3;
+
+        struct Config
+        {
+            std::chrono::microseconds agingPeriod{ 20000 };    // Wait promoting a transaction one class up
+            unsigned realTimeBurst = 8;                         // RealTime transactions in a row before an aged
+                                                                // one is served (0: RealTime always first)
+        };
+
+        struct ClassSnapshot
+        {
+            OperationSnapshot transactions;         // Queue wait + execution, bytes transferred
+            LatencyHistogram::Snapshot queueWait;
+            uint64_t promoted = 0;                  // Transactions served above their class (aging, RealTime share)
+        };
+
+        using Snapshot = std::array<ClassSnapshot, PrioritiesCount>;
+
+        /**
+         * @brief Create a scheduler and start its bus owner thread.
+         *
+         * @param master The real master of the bus.
+         * @param config The aging period.
+         * @return The scheduler.
+         */
+        static std::shared_ptr<I2CBusScheduler> create(std::shared_ptr<I2C::I2CMaster> master, const Config& config);
+        static std::shared_ptr<I2CBusScheduler> create(std::shared_ptr<I2C::I2CMaster> master);
+
+        // Delete the default copy constructor
+        I2CBusScheduler(const I2CBusScheduler&) = delete;
+        I2CBusScheduler& operator=(const I2CBusScheduler&) = delete;
+        // Delete the default move constructor
+        I2CBusScheduler(I2CBusScheduler&&) = delete;
+        I2CBusScheduler& operator=(I2CBusScheduler&&) = delete;
+        ~I2CBusScheduler();
+
+        /**
+         * @brief Get a master for the slaves of a priority class (it keeps the scheduler alive).
+         *
+         * @param priority The class of its transactions.
+         * @return The client master.
+         */
+        std::shared_ptr<I2C::I2CMaster> client(Priority priority);
+
+        /**
+         * @brief Stop the bus owner thread, the queued transactions are executed first, the next ones fail.
+         */
+        void stop();
+
+        size_t pending() const;
+        Snapshot metrics() const;
+
+    private:
+        class Client;
+
+        enum class Operation
+        {
+            Read,
+            Write,
+            WriteRead,
+            ReadWord,
+            WriteWord,
+            SetSpeed
+        };
+
+        // Lives on the caller stack until done
+        struct Transaction
+        {
+            Operation operation = Operation::Read;
+            Priority priority = Priority::Normal;
+            uint8_t address = 0;
+            const uint8_t* out = nullptr;
+            size_t outLength = 0;
+            uint8_t* in = nullptr;
+            size_t inLength = 0;
+            uint8_t command = 0;
+            uint16_t word = 0;
+            I2C::I2CMaster::Speed speed = I2C::I2CMaster::Speed::_100kbs;
+            I2C::I2CMaster::Transfer transfer{};
+            std::chrono::steady_clock::time_point queued;
+            int result = -1;
+            bool done = false;
+            std::condition_variable completed;
+        };
+
+        struct ClassMetrics
+        {
+            OperationMetrics transactions;
+            LatencyHistogram queueWait;
+            std::atomic<uint64_t> promoted{ 0 };
+        };
+
+        I2CBusScheduler(std::shared_ptr<I2C::I2CMaster> master, const Config& config);
+
+        /**
+         * @brief Queue a transaction and wait for its execution.
+         *
+         * @return The master result, -1 if the scheduler is stopped.
+         */
+        int execute(Transaction& transaction);
+
+        int perform(Transaction& transaction);
+        Transaction* next(std::chrono::steady_clock::time_point now);
+        void run();
+
+        const std::shared_ptr<I2C::I2CMaster> _master;
+        const Config _config;
+
+        std::array<std::deque<Transaction*>, PrioritiesCount> _queues;
+        std::array<ClassMetrics, PrioritiesCount> _metrics;
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+        unsigned _realTimeStreak = 0;   // RealTime transactions served in a row
+        bool _stopped = false;
+        boost::thread _thread;
+    };
+}
@@ -0,0 +1,142 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "I2CThroughputProbe.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace IoAdapter;
+
+std::vector<I2CThroughputProbe::Result> I2CThroughputProbe::run(const std::shared_ptr<I2C::I2CMaster>& master, const Config& config)
+{
+    std::vector<Result> results;
+    if (master == nullptr || config.length == 0 || config.iterations == 0)
+    {
+        std::cerr << "I2CThroughputProbe: invalid configuration" << std::endl;
+        return results;
+    }
+
+    Speed initialSpeed;
+    const bool restoreSpeed = master->getSpeed(initialSpeed) == 0;
+
+    // A master without transfer modes ignores the per transaction mode
+    auto modes = config.modes;
+    if (master->transferMode() == TransferMode::Default)
+    {
+        modes = { TransferMode::Default };
+    }
+
+    const uint8_t pointer = config.firstRegister;
+    std::vector<uint8_t> reference(config.length);
+    std::vector<uint8_t> data(config.length);
+    const auto expected = static_cast<int>(config.length);
+
+    for (const auto speed : config.speeds)
+    {
+        const bool supported = master->setSpeed(speed) == 0;
+        bool referenced = false;
+        if (supported && config.compareData)
+        {
+            const I2C::I2CMaster::Transfer transfer{ TransferMode::PerByte, false };
+            referenced = master->writeRead(config.address, &pointer, 1, reference.data(), reference.size(), transfer) == expected;
+        }
+
+        for (const auto mode : modes)
+        {
+            Result result;
+            result.speed = speed;
+            result.mode = mode;
+            result.supported = supported;
+            if (!supported || (config.compareData && !referenced))
+            {
+                results.push_back(result);
+                continue;
+            }
+
+            const I2C::I2CMaster::Transfer transfer{ mode, false };
+            bool works = true;
+            const auto start = std::chrono::steady_clock::now();
+            for (unsigned iteration = 0; iteration < config.iterations && works; ++iteration)
+            {
+                works = master->writeRead(config.address, &pointer, 1, data.data(), data.size(), transfer) == expected &&
+                        (!config.compareData || data == reference);
+            }
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            result.works = works;
+            if (works && elapsed.count() > 0)
+            {
+                result.perTransaction = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) / config.iterations;
+                result.bytesPerSecond = static_cast<double>(config.length) * config.iterations /
+                                        std::chrono::duration<double>(elapsed).count();
+            }
+            results.push_back(result);
+        }
+    }
+
+    if (restoreSpeed && master->setSpeed(initialSpeed) != 0)
+    {
+        std::cerr << "I2CThroughputProbe: failed to restore the bus speed" << std::endl;
+    }
+    return results;
+}
+
+const I2CThroughputProbe::Result* I2CThroughputProbe::fastest(const std::vector<Result>& results)
+{
+    const Result* best = nullptr;
+    for (const auto& result : results)
+    {
+        if (result.works && (best == nullptr || result.bytesPerSecond > best->bytesPerSecond))
+        {
+            best = &result;
+        }
+    }
+    return best;
+}
+
+void I2CThroughputProbe::print(std::ostream& out, const std::vector<Result>& results)
+{
+    const auto best = fastest(results);
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::left << std::setw(12) << "speed" << std::setw(12) << "mode" << std::right << std::setw(14) << "bytes/s"
+        << std::setw(16) << "us/transaction" << std::endl;
+    for (const auto& result : results)
+    {
+        out << std::left << std::setw(12) << (std::to_string(static_cast<int>(result.speed)) + " kb/s")
+            << std::setw(12) << modeName(result.mode) << std::right;
+        if (!result.supported)
+            out << std::setw(14) << "unsupported";
+        else if (!result.works)
+            out << std::setw(14) << "failed";
+        else
+            out << std::setw(14) << std::fixed << std::setprecision(0) << result.bytesPerSecond
+                << std::setw(16) << std::setprecision(1) << result.perTransaction.count() / 1000.0
+                << (&result == best ? "  fastest" : "");
+        out << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+const char* I2CThroughputProbe::modeName(const TransferMode mode)
+{
+    switch (mode)
+    {
+    case TransferMode::Default:
+        return "Default";
+    case TransferMode::PerByte:
+        return "PerByte";
+    case TransferMode::FastBytes:
+        return "FastBytes";
+    case TransferMode::FastBits:
+        return "FastBits";
+    }
+    return "?";
+}
@@ -0,0 +1,94 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Effective throughput of a slave at each bus speed and transfer mode, to pick the fastest mode it works with.
+    The probe only reads: a register block is read with a repeated start (register pointer write, then read),
+    the first read of each speed is made in PerByte mode (every acknowledge checked) and is the reference
+    data of the other modes. A mode works when every read of the block succeeds with the reference data.
+
+    The bus speed of the master is restored at the end, run it while the bus is otherwise idle: the other
+    slaves would see the probed speeds.
+
+    Exemple:
+    I2CThroughputProbe::Config config;
+    config.address = 0x40;
+    const auto results = I2CThroughputProbe::run(device, config);
+    I2CThroughputProbe::print(std::cout, results);
+    if (const auto best = I2CThroughputProbe::fastest(results))
+    {
+        device->setSpeed(best->speed);
+        device->setTransferMode(best->mode);
+    }
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "I2C.h"
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API I2CThroughputProbe final
+    {
+    public:
+        using Speed = I2C::I2CMaster::Speed;
+        using TransferMode = I2C::I2CMaster::TransferMode;
+
+        struct Config
+        {
+            uint8_t address = 0;            // 7-bit slave address
+            uint8_t firstRegister = 0;      // First register of the block read
+            size_t length = 32;             // Block length in bytes
+            unsigned iterations = 20;       // Reads per speed and mode
+            std::vector<Speed> speeds = { Speed::_10kbs, Speed::_100kbs, Speed::_200kbs, Speed::_400kbs,
+                                          Speed::_1mbs, Speed::_17mbs, Speed::_34mbs };
+            std::vector<TransferMode> modes = { TransferMode::PerByte, TransferMode::FastBytes, TransferMode::FastBits };
+            bool compareData = true;        // Check the data against the PerByte reference
+        };
+
+        struct Result
+        {
+            Speed speed = Speed::_100kbs;
+            TransferMode mode = TransferMode::Default;
+            bool supported = false;         // The master accepted the speed
+            bool works = false;             // Every read succeeded (with the reference data)
+            double bytesPerSecond = 0;      // Block bytes over the reads duration
+            std::chrono::nanoseconds perTransaction{ 0 };
+        };
+
+        I2CThroughputProbe() = delete;
+
+        /**
+         * @brief Measure every speed and mode of the configuration.
+         *
+         * @param master The I2C master (a master without transfer modes is measured once per speed, mode Default).
+         * @param config The slave and the speeds / modes to measure.
+         * @return One result per speed and mode, speed major.
+         */
+        static std::vector<Result> run(const std::shared_ptr<I2C::I2CMaster>& master, const Config& config);
+
+        /**
+         * @brief Get the working result of the highest throughput.
+         *
+         * @return The result, nullptr if nothing works.
+         */
+        static const Result* fastest(const std::vector<Result>& results);
+
+        /**
+         * @brief Print the results, one line per speed and mode.
+         */
+        static void print(std::ostream& out, const std::vector<Result>& results);
+
+        static const char* modeName(TransferMode mode);
+    };
+}
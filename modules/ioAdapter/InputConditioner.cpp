@@ -0,0 +1,162 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "InputConditioner.h"
+
+#include <algorithm>
+
+#include "Bitwise.h"
+
+using namespace IoAdapter;
+
+bool InputConditioner::configure(const io::inOut::Gpio gpio, const PinConfig& config)
+{
+    const auto pin = static_cast<size_t>(gpio);
+    if (pin >= PinsCount || (config.debounce == Debounce::Counter && config.samples == 0))
+        return false;
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _configs.at(pin) = config;
+    _pins.at(pin).integrator = Bitwise::getBitState(_state.load(), static_cast<int>(pin)) ? config.window : std::chrono::microseconds(0);
+    _pins.at(pin).stableSamples = 0;
+    return true;
+}
+
+InputConditioner::PinConfig InputConditioner::config(const io::inOut::Gpio gpio) const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _configs.at(static_cast<size_t>(gpio));
+}
+
+uint32_t InputConditioner::edgeCount(const io::inOut::Gpio gpio) const
+{
+    return _edgeCounts.at(static_cast<size_t>(gpio)).load();
+}
+
+void InputConditioner::resetEdgeCount(const io::inOut::Gpio gpio)
+{
+    _edgeCounts.at(static_cast<size_t>(gpio)).store(0);
+}
+
+bool InputConditioner::condition(const PinConfig& config, PinState& pin, const bool raw, const bool state,
+                                 const std::chrono::microseconds elapsed)
+{
+    switch (config.debounce)
+    {
+    case Debounce::None:
+        return raw;
+    case Debounce::Integrator:
+        {
+            if (config.window.count() <= 0)
+                return raw;
+
+            pin.integrator = raw ? std::min(pin.integrator + elapsed, config.window)
+                                 : std::max(pin.integrator - elapsed, std::chrono::microseconds(0));
+            if (pin.integrator >= config.window)
+                return true;
+            if (pin.integrator.count() <= 0)
+                return false;
+            return state;
+        }
+    case Debounce::Counter:
+        {
+            pin.stableSamples = raw != state ? static_cast<uint16_t>(pin.stableSamples + 1) : 0;
+            if (pin.stableSamples >= config.samples)
+            {
+                pin.stableSamples = 0;
+                return raw;
+            }
+            return state;
+        }
+    }
+    return raw;
+}
+
+// The raw input of a pin is back in its conditioned state since a whole debounce window (bounces included)
+bool InputConditioner::settled(const PinConfig& config, const PinState& pin, const std::chrono::steady_clock::time_point now,
+                               const std::chrono::microseconds samplePeriod)
+{
+    switch (config.debounce)
+    {
+    case Debounce::Integrator:
+        return now - pin.rawChange >= config.window;
+    case Debounce::Counter:
+        return now - pin.rawChange >= samplePeriod * config.samples;
+    default:
+        return true;
+    }
+}
+
+size_t InputConditioner::process(const uint16_t rawState, const uint16_t inputMask,
+                                 const std::chrono::steady_clock::time_point now,
+                                 const std::chrono::microseconds samplePeriod, Events& events)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    // The first sample has no duration
+    const auto elapsed = _sampled ? std::min(std::chrono::duration_cast<std::chrono::microseconds>(now - _lastSample), samplePeriod)
+                                  : std::chrono::microseconds(0);
+
+    const uint16_t previousState = _state.load();
+    uint32_t newState = previousState;
+    size_t count = 0;
+
+    for (size_t index = 0; index < PinsCount; ++index)
+    {
+        const auto bit = static_cast<int>(index);
+        if (!Bitwise::getBitState(inputMask, bit))
+            continue;
+
+        auto& pin = _pins[index];
+        const auto& config = _configs[index];
+        const bool raw = Bitwise::getBitState(rawState, bit);
+        if (raw != pin.raw)
+        {
+            pin.raw = raw;
+            pin.rawChange = now;
+            if (!pin.changing)
+            {
+                pin.changing = true;
+                pin.firstChange = now;
+            }
+        }
+
+        const bool state = Bitwise::getBitState(previousState, bit);
+        const bool conditioned = condition(config, pin, raw, state, elapsed);
+        if (conditioned == state)
+        {
+            // A glitch died out: the next transition starts a new edge
+            if (pin.changing && raw == state && settled(config, pin, now, samplePeriod))
+            {
+                pin.changing = false;
+            }
+            continue;
+        }
+
+        pin.changing = false;
+        conditioned ? Bitwise::setBit(newState, bit) : Bitwise::clearBit(newState, bit);
+
+        const auto edge = conditioned ? io::inOut::Edge::Rising : io::inOut::Edge::Falling;
+        if (config.edges == EdgeSelect::Both ||
+            (config.edges == EdgeSelect::Rising && edge == io::inOut::Edge::Rising) ||
+            (config.edges == EdgeSelect::Falling && edge == io::inOut::Edge::Falling))
+        {
+            events[count++] = { static_cast<io::inOut::Gpio>(index), edge, pin.firstChange, 0, ++_edgeCounts[index] };
+        }
+    }
+
+    // Pins which are not inputs are reported as sampled
+    newState = (newState & inputMask) | (rawState & ~inputMask);
+    for (size_t event = 0; event < count; ++event)
+    {
+        events[event].pinsState = static_cast<uint16_t>(newState);
+    }
+
+    _state.store(static_cast<uint16_t>(newState));
+    _lastSample = now;
+    _sampled = true;
+    return count;
+}
@@ -0,0 +1,142 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Per-pin input conditioning stage, runs on the device poll thread between the raw pins samples and the
+    inOut observers:
+    - Debounce:
+        - Integrator: the time the raw input spends high is integrated (and de-integrated while low) up to
+                      'window', the conditioned state follows the integrator once it saturates. A sample
+                      accounts for the time since the previous one, at most the nominal sampling period.
+        - Counter: the conditioned state follows the raw input once 'samples' consecutive samples agree.
+    - Edge selection: only the selected edges (rising, falling or both) are reported.
+    - Edge counters: number of reported edges per pin.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "inout.h"
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API InputConditioner final
+    {
+    public:
+        enum class Debounce
+        {
+            None,
+            Integrator,
+            Counter
+        };
+
+        enum class EdgeSelect
+        {
+            Rising,
+            Falling,
+            Both
+        };
+
+        struct PinConfig
+        {
+            Debounce debounce = Debounce::None;
+            std::chrono::microseconds window{ 0 };// Integrator window
+            uint16_t samples = 1;                 // Counter consecutive samples
+            EdgeSelect edges = EdgeSelect::Both;
+        };
+
+        static constexpr size_t PinsCount = 16;
+        using Events = std::array<io::inOut::InputEvent, PinsCount>;
+
+        InputConditioner() = default;
+        // Delete the default copy constructor
+        InputConditioner(const InputConditioner&) = delete;
+        InputConditioner& operator=(const InputConditioner&) = delete;
+        // Delete the default move constructor
+        InputConditioner(InputConditioner&&) = delete;
+        InputConditioner& operator=(InputConditioner&&) = delete;
+        ~InputConditioner() = default;
+
+        /**
+         * @brief Configures the conditioning of an input pin.
+         *
+         * @param gpio The GPIO pin (D0:C7).
+         * @param config The conditioning to apply.
+         * @return True if successful, false otherwise.
+         */
+        bool configure(io::inOut::Gpio gpio, const PinConfig& config);
+
+        /**
+         * @brief Get the conditioning of an input pin.
+         *
+         * @param gpio The GPIO pin (D0:C7).
+         * @return The pin conditioning.
+         */
+        PinConfig config(io::inOut::Gpio gpio) const;
+
+        /**
+         * @brief Get the number of reported edges of an input pin.
+         *
+         * @param gpio The GPIO pin (D0:C7).
+         * @return The number of edges since the last reset.
+         */
+        uint32_t edgeCount(io::inOut::Gpio gpio) const;
+
+        /**
+         * @brief Reset the edges counter of an input pin.
+         *
+         * @param gpio The GPIO pin (D0:C7).
+         */
+        void resetEdgeCount(io::inOut::Gpio gpio);
+
+        /**
+         * @brief Conditions a raw sample of the pins (poll thread).
+         *
+         * @param rawState The raw state of the pins (D0:D7 low byte, C0:C7 high byte).
+         * @param inputMask The pins configured as an input.
+         * @param now The sample time.
+         * @param samplePeriod The nominal sampling period, most time a sample accounts for in the integrators.
+         * @param events Reference to store the reported edges.
+         * @return The number of reported edges stored in events.
+         */
+        size_t process(uint16_t rawState, uint16_t inputMask, std::chrono::steady_clock::time_point now,
+                       std::chrono::microseconds samplePeriod, Events& events);
+
+        /**
+         * @brief Get the conditioned state of the pins.
+         *
+         * @return The conditioned state (D0:D7 low byte, C0:C7 high byte).
+         */
+        uint16_t state() const { return _state.load(); }
+
+    private:
+        struct PinState
+        {
+            std::chrono::microseconds integrator{ 0 };
+            uint16_t stableSamples = 0;
+            bool raw = false;
+            bool changing = false;                              // Raw transitions since the last conditioned change
+            std::chrono::steady_clock::time_point firstChange;  // First of them
+            std::chrono::steady_clock::time_point rawChange;    // Last of them
+        };
+
+        static bool condition(const PinConfig& config, PinState& pin, bool raw, bool state, std::chrono::microseconds elapsed);
+        static bool settled(const PinConfig& config, const PinState& pin, std::chrono::steady_clock::time_point now,
+                            std::chrono::microseconds samplePeriod);
+
+        std::array<PinConfig, PinsCount> _configs{};
+        std::array<PinState, PinsCount> _pins{};
+        std::array<std::atomic<uint32_t>, PinsCount> _edgeCounts{};
+        std::atomic<uint16_t> _state{ 0 };
+        std::chrono::steady_clock::time_point _lastSample;
+        bool _sampled = false;
+        mutable std::mutex _mutex;
+    };
+}
@@ -0,0 +1,88 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "IoExecutor.h"
+
+using namespace IoAdapter;
+
+IoExecutor::IoExecutor(std::function<void()> beginBatch, std::function<bool()> endBatch) :
+    _beginBatch(std::move(beginBatch)),
+    _endBatch(std::move(endBatch)),
+    _thread(boost::thread(&IoExecutor::run, this))
+{
+}
+
+IoExecutor::~IoExecutor()
+{
+    stop();
+}
+
+void IoExecutor::stop()
+{
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+    }
+    _condition.notify_one();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+size_t IoExecutor::pending() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _requests.size();
+}
+
+void IoExecutor::post(Task task)
+{
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        if (!_stopped)
+        {
+            _requests.push_back(std::move(task));
+            _condition.notify_one();
+            return;
+        }
+    }
+
+    // Nothing would execute it: failed right away
+    task(false)(false);
+}
+
+void IoExecutor::run()
+{
+    std::deque<Task> requests;
+    std::vector<Completion> completions;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return _stopped || !_requests.empty(); });
+            if (_requests.empty())
+                return;// Stopped & drained
+
+            requests.swap(_requests);
+        }
+
+        // Pipeline all the queued requests, their results are reported once the batch is sent
+        _beginBatch();
+        for (auto& request : requests)
+        {
+            completions.push_back(request(true));
+        }
+        const bool sent = _endBatch();
+        for (auto& completion : completions)
+        {
+            completion(sent);
+        }
+        completions.clear();
+        requests.clear();
+    }
+}
@@ -0,0 +1,149 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Owner thread of a device: the requests are queued by any thread and executed one after the other by the
+    owner thread, the callers get a future (or a completion callback) instead of blocking on the USB transfers.
+    All the requests queued at the same time are executed back-to-back between the beginBatch / endBatch hooks,
+    so the device can send them in a single transfer. Their futures / callbacks are completed after endBatch,
+    once the transfer is done.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API IoExecutor final
+    {
+    public:
+        IoExecutor(std::function<void()> beginBatch, std::function<bool()> endBatch);
+        // Delete the default copy constructor
+        IoExecutor(const IoExecutor&) = delete;
+        IoExecutor& operator=(const IoExecutor&) = delete;
+        // Delete the default move constructor
+        IoExecutor(IoExecutor&&) = delete;
+        IoExecutor& operator=(IoExecutor&&) = delete;
+        ~IoExecutor();
+
+        /**
+         * @brief Queue a request.
+         *
+         * @param request Callable executed by the owner thread.
+         * @return The future of the request result, ready once the batch is sent (a bool result is false
+         *         if the batch transfer failed). It holds the request exception, or a std::runtime_error
+         *         if the executor is stopped.
+         */
+        template <typename Request>
+        auto submit(Request&& request) -> std::future<decltype(request())>
+        {
+            using Result = decltype(request());
+            auto promise = std::make_shared<std::promise<Result>>();
+            auto future = promise->get_future();
+            post([request = std::forward<Request>(request), promise](const bool execute) mutable -> Completion
+            {
+                try
+                {
+                    if (!execute)
+                        throw std::runtime_error("IoExecutor stopped");
+
+                    if constexpr (std::is_void_v<Result>)
+                    {
+                        request();
+                        return [promise](bool) { promise->set_value(); };
+                    }
+                    else
+                    {
+                        return [promise, result = request()](const bool sent) mutable
+                        {
+                            promise->set_value(completed(std::move(result), sent));
+                        };
+                    }
+                }
+                catch (...)
+                {
+                    return [promise, error = std::current_exception()](bool) { promise->set_exception(error); };
+                }
+            });
+            return future;
+        }
+
+        /**
+         * @brief Queue a request with a completion callback.
+         *
+         * @param request Callable executed by the owner thread.
+         * @param completion Callable invoked by the owner thread with the request result once the batch is sent.
+         *                   It gets a default result (false for a bool) if the request throws, and is invoked
+         *                   right away by the calling thread if the executor is stopped.
+         */
+        template <typename Request, typename Completion>
+        void submit(Request&& request, Completion&& completion)
+        {
+            post([request = std::forward<Request>(request), completion = std::forward<Completion>(completion)](const bool execute) mutable
+                 -> IoExecutor::Completion
+            {
+                using Result = std::decay_t<decltype(request())>;
+                try
+                {
+                    if (execute)
+                    {
+                        return [completion, result = request()](const bool sent) mutable
+                        {
+                            completion(completed(std::move(result), sent));
+                        };
+                    }
+                }
+                catch (...)
+                {
+                }
+                return [completion](bool) mutable { completion(completed(Result{}, false)); };
+            });
+        }
+
+        /**
+         * @brief Stop the owner thread, the queued requests are executed first and the later ones fail.
+         */
+        void stop();
+
+        size_t pending() const;
+
+    private:
+        // Completes a request once its batch is sent (argument: the batch transfer succeeded)
+        using Completion = std::function<void(bool)>;
+
+        // Executes a request (argument: false to fail it without executing it) and returns its completion
+        using Task = std::function<Completion(bool)>;
+
+        // A GPIO write only succeeded if the batch holding it was sent
+        static bool completed(const bool result, const bool sent) { return result && sent; }
+
+        template <typename Result>
+        static Result completed(Result result, bool) { return result; }
+
+        void post(Task task);
+        void run();
+
+        std::function<void()> _beginBatch;
+        std::function<bool()> _endBatch;
+        std::deque<Task> _requests;
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _stopped = false;
+        boost::thread _thread;
+    };
+}
@@ -0,0 +1,130 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "Metrics.h"
+
+#include <algorithm>
+
+using namespace IoAdapter;
+
+// Position of the most significant bit (value > 0)
+static unsigned highestBit(uint64_t value)
+{
+    unsigned bit = 0;
+    for (unsigned shift = 32; shift > 0; shift /= 2)
+    {
+        if (value >> shift)
+        {
+            value >>= shift;
+            bit += shift;
+        }
+    }
+    return bit;
+}
+
+size_t LatencyHistogram::bucketOf(const uint64_t nanoseconds)
+{
+    // The first power of two range is linear with a 1 ns resolution
+    if (nanoseconds < SubBuckets)
+        return static_cast<size_t>(nanoseconds);
+
+    const unsigned exponent = highestBit(nanoseconds);
+    if (exponent > MaxExponent)
+        return BucketsCount - 1;
+
+    const auto subBucket = static_cast<size_t>(nanoseconds >> (exponent - SubBucketBits)) & (SubBuckets - 1);
+    return (exponent - SubBucketBits + 1) * SubBuckets + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(const size_t bucket)
+{
+    if (bucket < SubBuckets)
+        return bucket;
+
+    const auto exponent = static_cast<unsigned>(bucket / SubBuckets) + SubBucketBits - 1;
+    const auto subBucket = static_cast<uint64_t>(bucket % SubBuckets);
+    return (SubBuckets + subBucket) << (exponent - SubBucketBits);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(const size_t bucket)
+{
+    return bucket + 1 < BucketsCount ? bucketLowerBound(bucket + 1) - 1 : bucketLowerBound(bucket) * 2 - 1;
+}
+
+void LatencyHistogram::record(const std::chrono::nanoseconds latency)
+{
+    const auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+
+    _counts[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    auto max = _max.load(std::memory_order_relaxed);
+    while (nanoseconds > max && !_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    // Each field is read atomically, a snapshot taken during I/O may be off by the calls in progress
+    Snapshot snapshot;
+    for (size_t bucket = 0; bucket < BucketsCount; ++bucket)
+    {
+        snapshot.counts[bucket] = _counts[bucket].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.counts[bucket];
+    }
+    snapshot.sum = std::chrono::nanoseconds(_sum.load(std::memory_order_relaxed));
+    snapshot.max = std::chrono::nanoseconds(_max.load(std::memory_order_relaxed));
+    return snapshot;
+}
+
+std::chrono::nanoseconds LatencyHistogram::Snapshot::percentile(const double rank) const
+{
+    if (count == 0)
+        return std::chrono::nanoseconds(0);
+
+    const auto target = static_cast<uint64_t>(std::clamp(rank, 0.0, 1.0) * static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BucketsCount; ++bucket)
+    {
+        seen += counts[bucket];
+        if (seen >= target)
+        {
+            const auto middle = (bucketLowerBound(bucket) + bucketUpperBound(bucket)) / 2;
+            return std::min(std::chrono::nanoseconds(middle), max);
+        }
+    }
+    return max;
+}
+
+std::chrono::nanoseconds LatencyHistogram::Snapshot::mean() const
+{
+    return count > 0 ? sum / static_cast<int64_t>(count) : std::chrono::nanoseconds(0);
+}
+
+void OperationMetrics::record(const std::chrono::nanoseconds latency, const bool success, const uint64_t bytes)
+{
+    _latency.record(latency);
+    _calls.fetch_add(1, std::memory_order_relaxed);
+    if (!success)
+    {
+        _errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (bytes > 0)
+    {
+        _bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+OperationSnapshot OperationMetrics::snapshot() const
+{
+    OperationSnapshot snapshot;
+    snapshot.latency = _latency.snapshot();
+    snapshot.calls = _calls.load(std::memory_order_relaxed);
+    snapshot.errors = _errors.load(std::memory_order_relaxed);
+    snapshot.bytes = _bytes.load(std::memory_order_relaxed);
+    return snapshot;
+}
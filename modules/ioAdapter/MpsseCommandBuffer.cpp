@@ -0,0 +1,100 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "MpsseCommandBuffer.h"
+
+#include <cstring>
+
+using namespace IoAdapter;
+
+bool MpsseCommandBuffer::push(const uint8_t* bytes, const size_t count)
+{
+    if (count > remaining())
+        return false;
+
+    std::memcpy(_buffer.data() + _size, bytes, count);
+    _size += count;
+    _immediate = false;
+    return true;
+}
+
+bool MpsseCommandBuffer::append(const MpsseCommand command)
+{
+    const uint8_t opcode = static_cast<uint8_t>(command);
+    return push(&opcode, 1);
+}
+
+bool MpsseCommandBuffer::setDataBits(const bool highByte, const uint8_t value, const uint8_t direction)
+{
+    const uint8_t command[] = { static_cast<uint8_t>(highByte ? MpsseCommand::SetDataBitsHighbyte : MpsseCommand::SetDataBitsLowbyte),
+                                value,
+                                direction };
+    return push(command, sizeof(command));
+}
+
+bool MpsseCommandBuffer::getDataBits(const bool highByte)
+{
+    if (!append(highByte ? MpsseCommand::GetDataBitsHighbyte : MpsseCommand::GetDataBitsLowbyte))
+        return false;
+
+    ++_expectedResponse;
+    return true;
+}
+
+/*
+   0x8E, n     : clock for n + 1 bits (1 to 8)
+   0x8F, L, H  : clock for (H:L + 1) x 8 bits (8 to 524288)
+ */
+bool MpsseCommandBuffer::clockNoData(uint32_t bits)
+{
+    constexpr uint32_t maxBytes = 0x10000;
+    if (bits == 0 || bits > maxBytes * 8 + 8)
+        return false;
+
+    const size_t previousSize = _size;
+    if (bits >= 8)
+    {
+        const uint32_t bytes = bits / 8 > maxBytes ? maxBytes : bits / 8;
+        const uint8_t command[] = { static_cast<uint8_t>(MpsseCommand::ClockBytesNoData),
+                                    static_cast<uint8_t>((bytes - 1) & 0xFF),
+                                    static_cast<uint8_t>((bytes - 1) >> 8 & 0xFF) };
+        if (!push(command, sizeof(command)))
+            return false;
+        bits -= bytes * 8;
+    }
+
+    if (bits > 0)
+    {
+        const uint8_t command[] = { static_cast<uint8_t>(MpsseCommand::ClockBitsNoData),
+                                    static_cast<uint8_t>(bits - 1) };
+        if (!push(command, sizeof(command)))
+        {
+            _size = previousSize;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool MpsseCommandBuffer::sendImmediate()
+{
+    if (_expectedResponse == 0 || _immediate)
+        return true;
+
+    if (!append(MpsseCommand::SendImmediate))
+        return false;
+
+    _immediate = true;
+    return true;
+}
+
+void MpsseCommandBuffer::clear()
+{
+    _size = 0;
+    _expectedResponse = 0;
+    _immediate = false;
+}
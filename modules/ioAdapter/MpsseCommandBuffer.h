@@ -0,0 +1,135 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Preallocated MPSSE command buffer. The commands of several operations are appended one after the other
+    and sent to the FT232H by a single USB write, the number of bytes the MPSSE will answer is tracked so the
+    answers of all the queued read commands are collected by a single USB read.
+
+    Exemple (read D0:D7 & C0:C7 in one round trip):
+    +------+-------------------------------+
+    | 0x81 | Read D[7:0]      (1 answered) |
+    | 0x83 | Read C[7:0]      (1 answered) |
+    | 0x87 | Send immediate                |
+    +------+-------------------------------+
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "export.h"
+
+namespace IoAdapter
+{
+    enum class MpsseCommand : uint8_t {
+        SetDataBitsLowbyte = 0x80,
+        GetDataBitsLowbyte = 0x81,
+        SetDataBitsHighbyte = 0x82,
+        GetDataBitsHighbyte = 0x83,
+        LoopbackEnable = 0x84,
+        LoopbackDisable = 0x85,
+        SetClockDivisor = 0x86,
+        SendImmediate = 0x87,
+        WaitOnIoHigh = 0x88,
+        WaitOnIoLow = 0x89,
+        DisableClockDivide5 = 0x8A,
+        EnableClockDivide5 = 0x8B,
+        Enable3PhaseClocking = 0x8C,
+        Disable3PhaseClocking = 0x8D,
+        ClockBitsNoData = 0x8E,   // Clock for n bits (1 to 8) with no data transfer
+        ClockBytesNoData = 0x8F,  // Clock for n x 8 bits (8 to 524288) with no data transfer
+        DisableAdaptiveClocking = 0x97
+    };
+
+    class IO_ADAPTER_API MpsseCommandBuffer final
+    {
+    public:
+        static constexpr size_t Capacity = 4096;
+
+        MpsseCommandBuffer() = default;
+        // Delete the default copy constructor
+        MpsseCommandBuffer(const MpsseCommandBuffer&) = delete;
+        MpsseCommandBuffer& operator=(const MpsseCommandBuffer&) = delete;
+        // Delete the default move constructor
+        MpsseCommandBuffer(MpsseCommandBuffer&&) = delete;
+        MpsseCommandBuffer& operator=(MpsseCommandBuffer&&) = delete;
+        ~MpsseCommandBuffer() = default;
+
+        /**
+         * @brief Append a command without parameters.
+         *
+         * @param command The MPSSE opcode.
+         * @return True if successful, false if the buffer is full.
+         */
+        bool append(MpsseCommand command);
+
+        /**
+         * @brief Set the value & direction of D0:D7 (0x80) or C0:C7 (0x82).
+         *
+         * @param highByte False: D0:D7, True: C0:C7.
+         * @param value The pins values (1 = high).
+         * @param direction The pins directions (1 = output).
+         * @return True if successful, false if the buffer is full.
+         */
+        bool setDataBits(bool highByte, uint8_t value, uint8_t direction);
+
+        /**
+         * @brief Read the value of D0:D7 (0x81) or C0:C7 (0x83), 1 answered byte.
+         *
+         * @param highByte False: D0:D7, True: C0:C7.
+         * @return True if successful, false if the buffer is full.
+         */
+        bool getDataBits(bool highByte);
+
+        /**
+         * @brief Clock for n bits with no data transfer (0x8E / 0x8F).
+         *
+         * @param bits The number of clock periods (1 to 524296).
+         * @return True if successful, false if the buffer is full or bits out of range.
+         */
+        bool clockNoData(uint32_t bits);
+
+        /**
+         * @brief Get the size of the clockNoData() commands.
+         *
+         * @param bits The number of clock periods (1 to 524296).
+         * @return The size in bytes.
+         */
+        static size_t clockNoDataSize(const uint32_t bits)
+        {
+            const uint32_t bytes = std::min<uint32_t>(bits / 8, 0x10000);
+            const uint32_t rest = bits - bytes * 8;
+            return (bytes != 0 ? 3 : 0) + (rest != 0 ? 2 : 0);
+        }
+
+        /**
+         * @brief Append the Send Immediate command (0x87) if answers are expected and not yet flushed.
+         *
+         * @return True if successful, false if the buffer is full.
+         */
+        bool sendImmediate();
+
+        void clear();
+
+        const uint8_t* data() const { return _buffer.data(); }
+        uint8_t* data() { return _buffer.data(); }
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        size_t remaining() const { return Capacity - _size; }
+        size_t expectedResponse() const { return _expectedResponse; }
+
+    private:
+        bool push(const uint8_t* bytes, size_t count);
+
+        std::array<uint8_t, Capacity> _buffer{};
+        size_t _size = 0;
+        size_t _expectedResponse = 0;
+        bool _immediate = false;
+    };
+}
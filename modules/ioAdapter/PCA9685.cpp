@@ -1,6 +1,7 @@
 ﻿#include "PCA9685.h"
 #include <cmath>
-#include <boost/winapi/thread.hpp>
+#include <cstring>
+#include <iostream>
 
 using namespace ioAdapter;
 
@@ -17,24 +18,55 @@ PCA9685::~PCA9685()
 }
 
 
-void PCA9685::setPwmFrequency(const unsigned  freq)
+uint8_t PCA9685::prescaleOf(const unsigned freq)
 {
-    // Enable SLEEP mode(set bit 4)
-    writeWord(Register::MODE1, MODE1::SLEEP_1);
+    return static_cast<uint8_t>(round(OscillatorFrequency / (freq * 4096))) - 1;
+}
 
+void PCA9685::setPwmFrequency(const unsigned  freq)
+{
     // Calculate prescale value
-    const uint8_t prescale = static_cast<uint8_t>(round(OscillatorFrequency / (freq * 4096))) - 1;
-   
-    // Write prescale value to PRE_SCALE register
-    writeWord(Register::PRE_SCALE, prescale);
+    const uint8_t prescale = prescaleOf(freq);
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    // Same frequency: nothing to send
+    if (_known[Register::PRE_SCALE] && _registers[Register::PRE_SCALE] == prescale)
+        return;
+
+    // Enable SLEEP mode(set bit 4), the auto-increment and group address bits are kept
+    if (!updateMode1(MODE1::SLEEP_1, 0))
+    {
+        std::cerr << "PCA9685: failed to enter the sleep mode" << std::endl;
+        return;
+    }
+
+    // Write prescale value to PRE_SCALE register (only taken into account while sleeping)
+    writeRegister(Register::PRE_SCALE, prescale);
 
     // Exit SLEEP mode
-    writeWord(Register::MODE1, 0x00);
+    updateMode1(0, MODE1::SLEEP_1);
+}
 
+bool PCA9685::setGroupAddress(const Group group, const uint8_t address, const bool respond)
+{
+    static constexpr uint8_t registers[] = { Register::SUBADR1, Register::SUBADR2, Register::SUBADR3, Register::ALLCALLADR };
+    static constexpr uint8_t bits[] = { MODE1::SUB1_1, MODE1::SUB2_1, MODE1::SUB3_1, MODE1::ALLCALL_1 };
+    const auto index = static_cast<size_t>(group);
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    // The address is stored in the bits 7:1
+    if (respond && !writeRegister(registers[index], static_cast<uint8_t>(address << 1)))
+    {
+        std::cerr << "PCA9685: failed to write the group address" << std::endl;
+        return false;
+    }
+    return updateMode1(respond ? bits[index] : 0, respond ? 0 : bits[index]);
 }
 
 
-void  PCA9685::firePwm(const uint16_t pwmChannel, const double dutyCycle, const double delayTime)
+PCA9685::PwmSetting PCA9685::dutyCycleSetting(const double dutyCycle, const double delayTime)
 {
     constexpr int period = 4096;  // Total period
 
@@ -47,160 +79,330 @@ void  PCA9685::firePwm(const uint16_t pwmChannel, const double dutyCycle, const
     // Calculate the pulse width count
     const int pulseWidthCount = Thigh;
 
+    PwmSetting setting;
+    setting.on = static_cast<uint16_t>(delayCount & 0x1FFF);
+    setting.off = static_cast<uint16_t>((pulseWidthCount + delayCount) & 0x1FFF);
+    return setting;
+}
+
+void PCA9685::encode(const PwmSetting& setting, uint8_t* registers)
+{
+    registers[0] = static_cast<uint8_t>(setting.on & 0xFF);
+    registers[1] = static_cast<uint8_t>(setting.on >> 8 & 0xFF);
+    registers[2] = static_cast<uint8_t>(setting.off & 0xFF);
+    registers[3] = static_cast<uint8_t>(setting.off >> 8 & 0xFF);
+}
+
+void  PCA9685::firePwm(const uint16_t pwmChannel, const double dutyCycle, const double delayTime)
+{
     // Set LED ON and OFF registers for the servo control
-    const auto regs = selectPwmChannel(pwmChannel);
-    writeWord(static_cast<uint8_t>(regs.at(0)), delayCount & 0xFF);
-    writeWord(static_cast<uint8_t>(regs.at(1)), delayCount >> 8 & 0xFF);
-    writeWord(static_cast<uint8_t>(regs.at(2)), (pulseWidthCount + delayCount) & 0xFF);
-    writeWord(static_cast<uint8_t>(regs.at(3)), ((pulseWidthCount + delayCount) >> 8) & 0xFF);
+    setPwm(channel(pwmChannel), dutyCycleSetting(dutyCycle, delayTime));
 }
 
-//channel 0 to 15
-std::vector<PCA9685::Register> PCA9685::selectPwmChannel(const uint16_t channelNumber)
+bool PCA9685::setPwm(const Channel channel, const PwmSetting& setting)
 {
-    std::vector<Register> reg;
-    if (channelNumber < 17)
+    if (!channel.valid())
     {
-        switch (channelNumber)
+        std::cerr << "PCA9685: invalid channel" << std::endl;
+        return false;
+    }
+
+    uint8_t values[4];
+    encode(setting, values);
+
+    // Only the changed registers are sent, ON & OFF together (no half-updated pair)
+    const std::lock_guard<std::mutex> lock(_mutex);
+    stage(channel.firstRegister(), values, sizeof(values));
+    return flush();
+}
+
+bool PCA9685::setPwm(const Channel* channels, const PwmSetting* settings, const size_t count)
+{
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (!channels[index].valid())
         {
-        case 0:
-            {
-                reg.emplace_back(LED0_ON_L);
-                reg.emplace_back(LED0_ON_H);
-                reg.emplace_back(LED0_OFF_L);
-                reg.emplace_back(LED0_OFF_H);
-            }
-            break;
-        case 1:
-            {
-                reg.emplace_back(LED1_ON_L);
-                reg.emplace_back(LED1_ON_H);
-                reg.emplace_back(LED1_OFF_L);
-                reg.emplace_back(LED1_OFF_H);
-            }
-            break;
-        case 2:
-            {
-                reg.emplace_back(LED2_ON_L);
-                reg.emplace_back(LED2_ON_H);
-                reg.emplace_back(LED2_OFF_L);
-                reg.emplace_back(LED2_OFF_H);
-                }
-            break;
-        case 3:
-            {
-                reg.emplace_back(LED3_ON_L);
-                reg.emplace_back(LED3_ON_H);
-                reg.emplace_back(LED3_OFF_L);
-                reg.emplace_back(LED3_OFF_H);
-            }
-            break;
-        case 4:
-            {
-                reg.emplace_back(LED4_ON_L);
-                reg.emplace_back(LED4_ON_H);
-                reg.emplace_back(LED4_OFF_L);
-                reg.emplace_back(LED4_OFF_H);
-            }
-            break;
-        case 5:
-            {
-                reg.emplace_back(LED5_ON_L);
-                reg.emplace_back(LED5_ON_H);
-                reg.emplace_back(LED5_OFF_L);
-                reg.emplace_back(LED5_OFF_H);
-            }
-            break;
-        case 6:
-            {
-                reg.emplace_back(LED6_ON_L);
-                reg.emplace_back(LED6_ON_H);
-                reg.emplace_back(LED6_OFF_L);
-                reg.emplace_back(LED6_OFF_H);
-            }
-            break;
-        case 7:
-            {
-                reg.emplace_back(LED7_ON_L);
-                reg.emplace_back(LED7_ON_H);
-                reg.emplace_back(LED7_OFF_L);
-                reg.emplace_back(LED7_OFF_H);
-            }
-            break;
-        case 8:
-            {
-                reg.emplace_back(LED8_ON_L);
-                reg.emplace_back(LED8_ON_H);
-                reg.emplace_back(LED8_OFF_L);
-                reg.emplace_back(LED8_OFF_H);
-            }
-            break;
-        case 9:
-            {
-                reg.emplace_back(LED9_ON_L);
-                reg.emplace_back(LED9_ON_H);
-                reg.emplace_back(LED9_OFF_L);
-                reg.emplace_back(LED9_OFF_H);
-            }                    
-            break;
-        case 10:
-            {
-                reg.emplace_back(LED10_ON_L);
-                reg.emplace_back(LED10_ON_H);
-                reg.emplace_back(LED10_OFF_L);
-                reg.emplace_back(LED10_OFF_H);
-            }
-            break;
-        case 11:
-            {
-                reg.emplace_back(LED11_ON_L);
-                reg.emplace_back(LED11_ON_H);
-                reg.emplace_back(LED11_OFF_L);
-                reg.emplace_back(LED11_OFF_H);
-            }
-            break;
-        case 12:
-            {
-                reg.emplace_back(LED12_ON_L);
-                reg.emplace_back(LED12_ON_H);
-                reg.emplace_back(LED12_OFF_L);
-                reg.emplace_back(LED12_OFF_H);
-            }
-            break;
-        case 13:
-            {
-                reg.emplace_back(LED13_ON_L);
-                reg.emplace_back(LED13_ON_H);
-                reg.emplace_back(LED13_OFF_L);
-                reg.emplace_back(LED13_OFF_H);
-            }
-            break;
-        case 14:
-            {
-                reg.emplace_back(LED14_ON_L);
-                reg.emplace_back(LED14_ON_H);
-                reg.emplace_back(LED14_OFF_L);
-                reg.emplace_back(LED14_OFF_H);
-            }
-            break;
-        case 15:
+            std::cerr << "PCA9685: invalid channel" << std::endl;
+            return false;
+        }
+    }
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t index = 0; index < count; ++index)
+    {
+        uint8_t values[4];
+        encode(settings[index], values);
+        stage(channels[index].firstRegister(), values, sizeof(values));
+    }
+    return flush();
+}
+
+uint8_t PCA9685::prescale() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _known[Register::PRE_SCALE] ? _registers[Register::PRE_SCALE] : DefaultPrescale;
+}
+
+bool PCA9685::setDutyCounts(const Channel channel, const uint16_t dutyCounts, const uint16_t delayCounts)
+{
+    return setPwm(channel, dutyCountsSetting(dutyCounts, delayCounts));
+}
+
+PCA9685::PwmSetting PCA9685::dutyCountsSetting(const uint16_t dutyCounts, const uint16_t delayCounts)
+{
+    PwmSetting setting;
+    if (dutyCounts == 0)
+    {
+        setting.on = 0;
+        setting.off = PwmSetting::FullOff;
+    }
+    else if (dutyCounts >= 4096)
+    {
+        setting.on = PwmSetting::FullOn;
+        setting.off = 0;
+    }
+    else
+    {
+        // The OFF count wraps to the next period
+        setting.on = delayCounts & 0x0FFF;
+        setting.off = static_cast<uint16_t>((setting.on + dutyCounts) & 0x0FFF);
+    }
+    return setting;
+}
+
+bool PCA9685::setPulseWidth(const Channel channel, const uint32_t microseconds)
+{
+    return setDutyCounts(channel, pulseWidthCounts(microseconds, prescale()));
+}
+
+bool PCA9685::writeFrame(const Frame& frame)
+{
+    uint8_t values[ChannelsCount * 4];
+    for (size_t channel = 0; channel < ChannelsCount; ++channel)
+    {
+        encode(frame[channel], values + channel * 4);
+    }
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    stage(Register::LED0_ON_L, values, sizeof(values));
+    return flush();
+}
+
+bool PCA9685::setAll(const PwmSetting& setting)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (!_autoIncrement && !enableAutoIncrement())
+        return false;
+
+    uint8_t values[4];
+    encode(setting, values);
+
+    // The ALL_LED registers are write only and override the channels: always sent, the LEDn shadow is dropped
+    for (unsigned reg = Register::LED0_ON_L; reg <= Register::LED15_OFF_H; ++reg)
+    {
+        _known[reg] = false;
+        _dirty[reg] = false;
+    }
+    return writeRegisters(Register::ALL_LED_ON_L, values, sizeof(values));
+}
+
+void PCA9685::invalidate()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _known.reset();
+    _dirty.reset();
+    _autoIncrement = false;
+}
+
+bool PCA9685::setAllFull(const bool on)
+{
+    // A full OFF has priority over a full ON
+    PwmSetting setting;
+    setting.on = on ? PwmSetting::FullOn : 0;
+    setting.off = on ? 0 : PwmSetting::FullOff;
+    return setAll(setting);
+}
+
+// The caller must hold _mutex
+bool PCA9685::enableAutoIncrement()
+{
+    if (!updateMode1(MODE1::AI_1, 0))
+    {
+        std::cerr << "PCA9685: failed to enable the auto-increment" << std::endl;
+        return false;
+    }
+
+    _autoIncrement = true;
+    return true;
+}
+
+// The caller must hold _mutex
+bool PCA9685::loadMode1()
+{
+    if (_known[Register::MODE1])
+        return true;
+
+    uint8_t mode1 = 0;
+    if (readRegisters(Register::MODE1, &mode1, 1) != 1)
+    {
+        std::cerr << "PCA9685: failed to read MODE1" << std::endl;
+        return false;
+    }
+    _registers[Register::MODE1] = mode1;
+    _known[Register::MODE1] = true;
+    return true;
+}
+
+// The caller must hold _mutex
+bool PCA9685::updateMode1(const uint8_t set, const uint8_t clear)
+{
+    if (!loadMode1())
+        return false;
+
+    // Writing RESTART back as 1 would restart the PWM channels
+    const auto mode1 = static_cast<uint8_t>((_registers[Register::MODE1] & ~(MODE1::RESTART_1 | clear)) | set);
+    return writeRegister(Register::MODE1, mode1);
+}
+
+bool PCA9685::holds(const uint8_t first, const uint8_t* values, const size_t count) const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t index = 0; index < count; ++index)
+    {
+        const auto reg = first + index;
+        if (reg >= RegistersCount || !_known[reg] || _dirty[reg] || _registers[reg] != values[index])
+            return false;
+    }
+    return true;
+}
+
+void PCA9685::groupWritten(const uint8_t first, const uint8_t* values, const size_t count, const bool written)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t index = 0; index < count && first + index < RegistersCount; ++index)
+    {
+        const auto reg = first + index;
+        _registers[reg] = values[index];
+        _known[reg] = written;
+        _dirty[reg] = false;
+
+        // The ALL_LED registers override the channels (see setAll)
+        if (reg >= Register::ALL_LED_ON_L && reg <= Register::ALL_LED_OFF_H)
+        {
+            for (unsigned led = Register::LED0_ON_L; led <= Register::LED15_OFF_H; ++led)
             {
-                reg.emplace_back(LED15_ON_L);
-                reg.emplace_back(LED15_ON_H);
-                reg.emplace_back(LED15_OFF_L);
-                reg.emplace_back(LED15_OFF_H);
+                _known[led] = false;
+                _dirty[led] = false;
             }
-            break;
-        default:
+        }
+    }
+
+    if (first == Register::MODE1 && count > 0)
+    {
+        _autoIncrement = _known[Register::MODE1] && (_registers[Register::MODE1] & MODE1::AI_1) != 0;
+    }
+}
+
+// The caller must hold _mutex
+bool PCA9685::writeRegister(const uint8_t reg, const uint8_t value)
+{
+    if (_known[reg] && _registers[reg] == value)
+        return true;
+
+    if (writeWord(reg, value) != 0)
+    {
+        _known[reg] = false;
+        return false;
+    }
+    _registers[reg] = value;
+    _known[reg] = true;
+    _dirty[reg] = false;
+    return true;
+}
+
+bool PCA9685::writeRegisters(const uint8_t first, const uint8_t* values, const size_t count)
+{
+    if (count == 0 || count > MaxBurst)
+        return false;
+
+    // Register address followed by the values
+    uint8_t buffer[1 + MaxBurst];
+    buffer[0] = first;
+    std::memcpy(buffer + 1, values, count);
+    return write(buffer, count + 1) == static_cast<int>(count + 1);
+}
+
+// Update the shadow, the caller must hold _mutex
+void PCA9685::stage(const uint8_t first, const uint8_t* values, const size_t count)
+{
+    for (size_t index = 0; index < count && first + index < RegistersCount; ++index)
+    {
+        const auto reg = first + index;
+        if (!_known[reg] || _registers[reg] != values[index])
+        {
+            _registers[reg] = values[index];
+            _dirty[reg] = true;
+        }
+    }
+}
+
+/*
+   Send the dirty registers, the caller must hold _mutex.
+   A burst goes on over up to MaxCoalescedGap clean (and known) registers: resending a few unchanged
+   bytes costs less than another start/address/register/stop sequence.
+ */
+bool PCA9685::flush()
+{
+    if (_dirty.none())
+        return true;
+
+    const bool burst = _autoIncrement || enableAutoIncrement();
+    bool success = true;
+
+    size_t reg = 0;
+    while (reg < RegistersCount)
+    {
+        if (!_dirty[reg])
+        {
+            ++reg;
+            continue;
+        }
+
+        // [first, last] is the burst
+        const size_t first = reg;
+        size_t last = reg;
+        size_t next = reg + 1;
+        while (burst && next < RegistersCount && next - first < MaxBurst)
+        {
+            if (_dirty[next])
             {
-                reg.emplace_back(UNDEFINED);
-                reg.emplace_back(UNDEFINED);
-                reg.emplace_back(UNDEFINED);
-                reg.emplace_back(UNDEFINED);
+                last = next++;
+                continue;
             }
-            break;
+            if (!_known[next] || next - last > MaxCoalescedGap)
+                break;
+            ++next;
+        }
+
+        bool written;
+        if (burst)
+        {
+            written = writeRegisters(static_cast<uint8_t>(first), _registers.data() + first, last - first + 1);
+        }
+        else
+        {
+            // No auto-increment: one transaction per register
+            written = writeWord(static_cast<uint8_t>(first), _registers[first]) == 0;
         }
-    }
 
-    return reg;
-}
\ No newline at end of file
+        for (auto index = first; index <= last; ++index)
+        {
+            // A failed register stays dirty and is resent by the next flush
+            _known[index] = written;
+            _dirty[index] = !written;
+        }
+        success = success && written;
+        reg = last + 1;
+    }
+    return success;
+}
@@ -90,8 +90,12 @@
 
 
 #pragma once
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <vector>
+#include <mutex>
 
 #include "I2C.h"
 
@@ -102,6 +106,62 @@ namespace ioAdapter
     class IO_ADAPTER_API PCA9685: public I2C::I2CSlave
     {
     public:
+        static constexpr size_t ChannelsCount = 16;
+
+        /**
+         * @brief LEDn_ON / LEDn_OFF counts of a channel (0 to 4095, FullOn / FullOff set the bit 12).
+         */
+        struct PwmSetting
+        {
+            static constexpr uint16_t FullOn = 0x1000;
+            static constexpr uint16_t FullOff = 0x1000;
+
+            uint16_t on = 0;
+            uint16_t off = FullOff;
+        };
+
+        using Frame = std::array<PwmSetting, ChannelsCount>;
+
+        /**
+         * @brief Channel handle: the address of its LEDn_ON_L register, resolved once (no lookup per update).
+         */
+        class Channel
+        {
+        public:
+            constexpr Channel() = default;
+            constexpr uint8_t firstRegister() const { return _firstRegister; }
+            constexpr bool valid() const { return _firstRegister != 0; }
+
+        private:
+            friend class PCA9685;
+            constexpr explicit Channel(const uint8_t firstRegister) : _firstRegister(firstRegister) {}
+
+            uint8_t _firstRegister = 0;
+        };
+
+        /**
+         * @brief Get the handle of a channel known at compile time.
+         *
+         * Exemple: constexpr auto led3 = PCA9685::channel<3>();
+         */
+        template <unsigned Number>
+        static constexpr Channel channel()
+        {
+            static_assert(Number < ChannelsCount, "The PCA9685 has 16 channels (0 to 15)");
+            return Channel(static_cast<uint8_t>(FirstLedRegister + 4 * Number));
+        }
+
+        /**
+         * @brief Get the handle of a channel.
+         *
+         * @param number The channel (0 to 15).
+         * @return The handle, invalid (valid() == false) if the channel doesn't exist.
+         */
+        static constexpr Channel channel(const unsigned number)
+        {
+            return number < ChannelsCount ? Channel(static_cast<uint8_t>(FirstLedRegister + 4 * number)) : Channel();
+        }
+
         PCA9685(const std::shared_ptr<I2C::I2CMaster>& master,
             const uint8_t addr = 0x40);
         // Delete the default copy constructor
@@ -113,10 +173,234 @@ namespace ioAdapter
         ~PCA9685() override;
 
         void setPwmFrequency(unsigned  freq);
+
+        /**
+         * @brief Set the duty cycle of a channel, its 4 LED registers are sent in one burst write
+         *        (MODE1 auto-increment is enabled by the first call).
+         *
+         * @param pwmChannel The channel (0 to 15).
+         * @param dutyCycle The duty cycle in %.
+         * @param delayTime The delay before the rising edge.
+         */
         void firePwm(uint16_t pwmChannel, double dutyCycle, double delayTime = 0);
 
+        /**
+         * @brief Set the ON / OFF counts of a channel (integer path: no allocation, no floating point).
+         *
+         * @param channel The channel handle.
+         * @param setting The ON / OFF counts.
+         * @return True if successful (or unchanged), false otherwise.
+         */
+        bool setPwm(Channel channel, const PwmSetting& setting);
+
+        /**
+         * @brief Set several channels at once: their changed registers are sent together (one burst when
+         *        they are close enough, see MaxCoalescedGap).
+         *
+         * @param channels The channel handles.
+         * @param settings The ON / OFF counts of each channel.
+         * @param count The number of channels.
+         * @return True if successful (or unchanged), false otherwise.
+         */
+        bool setPwm(const Channel* channels, const PwmSetting* settings, size_t count);
+
+        /**
+         * @brief Get the PRE_SCALE value in use (200 Hz chip default until setPwmFrequency()).
+         */
+        uint8_t prescale() const;
+
+        /**
+         * @brief Set the duty cycle of a channel in 12 bits counts.
+         *
+         * @param channel The channel handle.
+         * @param dutyCounts The high time (0: full off, 4096 and more: full on).
+         * @param delayCounts The delay before the rising edge (0 to 4095).
+         * @return True if successful (or unchanged), false otherwise.
+         */
+        bool setDutyCounts(Channel channel, uint16_t dutyCounts, uint16_t delayCounts = 0);
+
+        /**
+         * @brief Compute the setting of a duty cycle in 12 bits counts (see setDutyCounts).
+         */
+        static PwmSetting dutyCountsSetting(uint16_t dutyCounts, uint16_t delayCounts = 0);
+
+        /**
+         * @brief Set the high time of a channel in microseconds (servo pulses), the PWM period comes from
+         *        the last setPwmFrequency() (200 Hz chip default before).
+         *
+         * @param channel The channel handle.
+         * @param microseconds The pulse width.
+         * @return True if successful (or unchanged), false otherwise.
+         */
+        bool setPulseWidth(Channel channel, uint32_t microseconds);
+
+        /**
+         * @brief Convert a pulse width to 12 bits counts.
+         *
+         * @param microseconds The pulse width.
+         * @param prescale The PRE_SCALE value (one count lasts (prescale + 1) * 40 ns).
+         * @return The counts, 4096 if the pulse covers the whole period.
+         */
+        static constexpr uint16_t pulseWidthCounts(const uint32_t microseconds, const uint8_t prescale)
+        {
+            // 25 counts per us at prescale 0, rounded to the nearest count
+            const uint64_t counts = (static_cast<uint64_t>(microseconds) * 25 + (prescale + 1u) / 2) / (prescale + 1u);
+            return static_cast<uint16_t>(counts < 4096 ? counts : 4096);
+        }
+
+        /**
+         * @brief Compute the setting of a duty cycle (same counts as firePwm).
+         *
+         * @param dutyCycle The duty cycle in %.
+         * @param delayTime The delay before the rising edge.
+         * @return The ON / OFF counts.
+         */
+        static PwmSetting dutyCycleSetting(double dutyCycle, double delayTime = 0);
+
+        /**
+         * @brief Update the 16 channels with one 64 bytes auto-increment write from LED0_ON_L.
+         *
+         * @param frame The settings of the channels 0 to 15.
+         * @return True if successful, false otherwise.
+         */
+        bool writeFrame(const Frame& frame);
+
+        /**
+         * @brief Load every channel at once through the ALL_LED_ON / ALL_LED_OFF registers.
+         *
+         * @param setting The ON / OFF counts applied to the 16 channels.
+         * @return True if successful, false otherwise.
+         */
+        bool setAll(const PwmSetting& setting);
+
+        /**
+         * @brief Turn every channel fully on or fully off (ALL_LED registers).
+         *
+         * @param on True: full on, false: full off.
+         * @return True if successful, false otherwise.
+         */
+        bool setAllFull(bool on);
+
+        /**
+         * @brief Forget the shadow registers (chip reset or power cycle), the next writes are all sent.
+         */
+        void invalidate();
+
+        /**
+         * @brief I2C group addresses: the chip also accepts writes sent to them (SUB1 to SUB3 and LED All Call).
+         */
+        enum class Group
+        {
+            Sub1,
+            Sub2,
+            Sub3,
+            AllCall
+        };
+
+        /**
+         * @brief Program a group address (SUBADRx / ALLCALLADR) and make the chip respond to it or not (MODE1).
+         *
+         * @param group The group.
+         * @param address The 7-bit group address.
+         * @param respond True to accept the writes sent to the group address.
+         * @return True if successful, false otherwise.
+         */
+        bool setGroupAddress(Group group, uint8_t address, bool respond = true);
+
 
     private:
+        friend class PCA9685Array;
+
+        static constexpr uint8_t FirstLedRegister = 0x06;// LED0_ON_L
+        static constexpr uint8_t DefaultPrescale = 0x1E;// PRE_SCALE at power up (200 Hz)
+        static constexpr size_t MaxBurst = 64;// LED0_ON_L to LED15_OFF_H
+        static constexpr size_t MaxCoalescedGap = 4;// Clean registers resent to merge two dirty ranges
+        static constexpr size_t RegistersCount = 256;
+
+        /**
+         * @brief Set MODE1 auto-increment (read-modify-write), needed by the burst writes.
+         *
+         * @return True if successful, false otherwise.
+         */
+        bool enableAutoIncrement();
+
+        /**
+         * @brief Read MODE1 in the shadow if it isn't known yet.
+         *
+         * @return True if successful, false otherwise.
+         */
+        bool loadMode1();
+
+        /**
+         * @brief Change MODE1 bits, the others are kept (read-modify-write).
+         *
+         * @param set The bits set.
+         * @param clear The bits cleared.
+         * @return True if successful, false otherwise.
+         */
+        bool updateMode1(uint8_t set, uint8_t clear);
+
+        /**
+         * @brief Compute the PRE_SCALE value of a PWM frequency (internal 25 MHz oscillator).
+         */
+        static uint8_t prescaleOf(unsigned freq);
+
+        /**
+         * @brief Check if the shadow holds these register values (all known).
+         */
+        bool holds(uint8_t first, const uint8_t* values, size_t count) const;
+
+        /**
+         * @brief Update the shadow after a write sent to a group address (the chip didn't see it through
+         *        this object).
+         *
+         * @param first The first register.
+         * @param values The registers values.
+         * @param count The number of registers.
+         * @param written False if the write failed: the registers become unknown.
+         */
+        void groupWritten(uint8_t first, const uint8_t* values, size_t count, bool written);
+
+        /**
+         * @brief Write consecutive registers in one I2C transaction (MODE1 auto-increment).
+         *
+         * @param first The first register.
+         * @param values The registers values.
+         * @param count The number of registers (up to MaxBurst).
+         * @return True if successful, false otherwise.
+         */
+        bool writeRegisters(uint8_t first, const uint8_t* values, size_t count);
+
+        /**
+         * @brief Write one register now, skipped if the shadow already holds the value.
+         *
+         * @param reg The register.
+         * @param value The value.
+         * @return True if successful, false otherwise.
+         */
+        bool writeRegister(uint8_t reg, uint8_t value);
+
+        /**
+         * @brief Copy values in the shadow registers, the changed ones are marked dirty.
+         */
+        void stage(uint8_t first, const uint8_t* values, size_t count);
+
+        /**
+         * @brief Send the dirty registers, the contiguous ones coalesced in burst writes.
+         *
+         * @return True if successful, false otherwise (the failed registers stay dirty).
+         */
+        bool flush();
+
+        // LEDn_ON_L, LEDn_ON_H, LEDn_OFF_L, LEDn_OFF_H
+        static void encode(const PwmSetting& setting, uint8_t* registers);
+
+        // Shadow copy of the chip registers
+        std::array<uint8_t, RegistersCount> _registers{};
+        std::bitset<RegistersCount> _known;  // Value known to match the chip
+        std::bitset<RegistersCount> _dirty;  // Value changed, not sent yet
+        bool _autoIncrement = false;
+        mutable std::mutex _mutex;
 
         enum Register {
             MODE1 = 0x00,         // Mode register 1
@@ -300,7 +584,5 @@ namespace ioAdapter
         };
 
 
-        std::vector<Register> selectPwmChannel(uint16_t channelNumber);
-
     };
 }
@@ -0,0 +1,290 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "PCA9685Array.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace ioAdapter;
+
+PCA9685Array::PCA9685Array(const std::shared_ptr<I2C::I2CMaster>& master, const std::vector<uint8_t>& addresses,
+                           const uint8_t allCallAddress):
+    _master(master)
+{
+    auto& allCall = _groups[static_cast<size_t>(Group::AllCall)];
+    allCall.defined = true;
+    allCall.address = allCallAddress;
+
+    for (const auto address : addresses)
+    {
+        allCall.devices.push_back(_devices.size());
+        _devices.push_back(std::make_shared<PCA9685>(master, address));
+    }
+}
+
+bool PCA9685Array::begin()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto address = _groups[static_cast<size_t>(Group::AllCall)].address;
+
+    bool success = true;
+    for (const auto& device : _devices)
+    {
+        if (!device->setGroupAddress(Group::AllCall, address))
+        {
+            success = false;
+            continue;
+        }
+
+        const std::lock_guard<std::mutex> deviceLock(device->_mutex);
+        success = (device->_autoIncrement || device->enableAutoIncrement()) && success;
+    }
+    return success;
+}
+
+std::shared_ptr<PCA9685> PCA9685Array::device(const size_t index) const
+{
+    return index < _devices.size() ? _devices[index] : nullptr;
+}
+
+bool PCA9685Array::defineGroup(const Group group, const uint8_t address, const std::vector<size_t>& devices)
+{
+    if (group == Group::AllCall)
+    {
+        std::cerr << "PCA9685Array: the All Call group is made of every device" << std::endl;
+        return false;
+    }
+    for (const auto index : devices)
+    {
+        if (index >= _devices.size())
+        {
+            std::cerr << "PCA9685Array: invalid device " << index << std::endl;
+            return false;
+        }
+    }
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    auto& members = _groups[static_cast<size_t>(group)];
+    members.defined = false;
+    members.address = address;
+    members.devices.clear();
+
+    bool success = true;
+    for (size_t index = 0; index < _devices.size(); ++index)
+    {
+        const bool member = std::find(devices.begin(), devices.end(), index) != devices.end();
+        success = _devices[index]->setGroupAddress(group, address, member) && success;
+        if (member)
+        {
+            members.devices.push_back(index);
+        }
+    }
+
+    // A device that missed its setting would get (or miss) the group writes
+    members.defined = success;
+    return success;
+}
+
+bool PCA9685Array::setPwm(const size_t channel, const PwmSetting& setting)
+{
+    if (channel >= channelsCount())
+    {
+        std::cerr << "PCA9685Array: invalid channel " << channel << std::endl;
+        return false;
+    }
+    return _devices[channel / PCA9685::ChannelsCount]->setPwm(
+        PCA9685::channel(static_cast<unsigned>(channel % PCA9685::ChannelsCount)), setting);
+}
+
+bool PCA9685Array::setPwm(const size_t* channels, const PwmSetting* settings, const size_t count)
+{
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (channels[index] >= channelsCount())
+        {
+            std::cerr << "PCA9685Array: invalid channel " << channels[index] << std::endl;
+            return false;
+        }
+    }
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    bool success = true;
+    for (size_t device = 0; device < _devices.size(); ++device)
+    {
+        _batchChannels.clear();
+        _batchSettings.clear();
+        for (size_t index = 0; index < count; ++index)
+        {
+            if (channels[index] / PCA9685::ChannelsCount == device)
+            {
+                _batchChannels.push_back(PCA9685::channel(static_cast<unsigned>(channels[index] % PCA9685::ChannelsCount)));
+                _batchSettings.push_back(settings[index]);
+            }
+        }
+
+        // One flush per device: its changed registers coalesced in a burst
+        if (!_batchChannels.empty())
+        {
+            success = _devices[device]->setPwm(_batchChannels.data(), _batchSettings.data(), _batchChannels.size()) && success;
+        }
+    }
+    return success;
+}
+
+bool PCA9685Array::setPwm(const Group group, const PCA9685::Channel channel, const PwmSetting& setting)
+{
+    if (!channel.valid())
+    {
+        std::cerr << "PCA9685Array: invalid channel" << std::endl;
+        return false;
+    }
+
+    uint8_t values[4];
+    PCA9685::encode(setting, values);
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto& members = _groups[static_cast<size_t>(group)];
+    if (unchanged(members, channel.firstRegister(), values, sizeof(values)))
+        return true;
+    return broadcast(members, channel.firstRegister(), values, sizeof(values));
+}
+
+bool PCA9685Array::writeFrame(const Group group, const PCA9685::Frame& frame)
+{
+    uint8_t values[PCA9685::ChannelsCount * 4];
+    for (size_t channel = 0; channel < PCA9685::ChannelsCount; ++channel)
+    {
+        PCA9685::encode(frame[channel], values + channel * 4);
+    }
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto& members = _groups[static_cast<size_t>(group)];
+    if (unchanged(members, PCA9685::FirstLedRegister, values, sizeof(values)))
+        return true;
+    return broadcast(members, PCA9685::FirstLedRegister, values, sizeof(values));
+}
+
+bool PCA9685Array::setAll(const Group group, const PwmSetting& setting)
+{
+    uint8_t values[4];
+    PCA9685::encode(setting, values);
+
+    // Write only registers: always sent
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return broadcast(_groups[static_cast<size_t>(group)], PCA9685::Register::ALL_LED_ON_L, values, sizeof(values));
+}
+
+bool PCA9685Array::setAllFull(const bool on)
+{
+    // A full OFF has priority over a full ON
+    PwmSetting setting;
+    setting.on = on ? PwmSetting::FullOn : 0;
+    setting.off = on ? 0 : PwmSetting::FullOff;
+    return setAll(Group::AllCall, setting);
+}
+
+bool PCA9685Array::setPwmFrequency(const unsigned freq)
+{
+    const uint8_t prescale = PCA9685::prescaleOf(freq);
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto& all = _groups[static_cast<size_t>(Group::AllCall)];
+    if (_devices.empty() || unchanged(all, PCA9685::Register::PRE_SCALE, &prescale, 1))
+        return true;
+
+    // MODE1 of the devices, awake (the SUBx bits differ between the groups)
+    std::vector<uint8_t> modes;
+    for (const auto& device : _devices)
+    {
+        const std::lock_guard<std::mutex> deviceLock(device->_mutex);
+        if (!device->loadMode1())
+            return false;
+        modes.push_back(static_cast<uint8_t>(device->_registers[PCA9685::Register::MODE1] &
+                                             ~(PCA9685::MODE1::RESTART_1 | PCA9685::MODE1::SLEEP_1)));
+    }
+    const bool sameMode = std::all_of(modes.begin(), modes.end(), [&](const uint8_t mode) { return mode == modes.front(); });
+
+    // PRE_SCALE is only written while sleeping
+    auto sleep = [&](const bool enter)
+    {
+        if (sameMode)
+        {
+            const auto mode1 = static_cast<uint8_t>(modes.front() | (enter ? PCA9685::MODE1::SLEEP_1 : 0));
+            return broadcast(all, PCA9685::Register::MODE1, &mode1, 1);
+        }
+
+        bool success = true;
+        for (const auto& device : _devices)
+        {
+            const std::lock_guard<std::mutex> deviceLock(device->_mutex);
+            success = device->updateMode1(enter ? PCA9685::MODE1::SLEEP_1 : 0, enter ? 0 : PCA9685::MODE1::SLEEP_1) && success;
+        }
+        return success;
+    };
+
+    if (!sleep(true))
+    {
+        std::cerr << "PCA9685Array: failed to enter the sleep mode" << std::endl;
+        sleep(false);
+        return false;
+    }
+    const bool written = broadcast(all, PCA9685::Register::PRE_SCALE, &prescale, 1);
+    return sleep(false) && written;
+}
+
+// The caller must hold _mutex
+bool PCA9685Array::broadcast(const GroupMembers& group, const uint8_t first, const uint8_t* values, const size_t count)
+{
+    if (!group.defined || group.devices.empty())
+    {
+        std::cerr << "PCA9685Array: group not defined" << std::endl;
+        return false;
+    }
+    if (count == 0 || count > PCA9685::MaxBurst)
+        return false;
+
+    // The bursts need the auto-increment of every member
+    if (count > 1)
+    {
+        for (const auto index : group.devices)
+        {
+            const auto& device = _devices[index];
+            const std::lock_guard<std::mutex> deviceLock(device->_mutex);
+            if (!device->_autoIncrement && !device->enableAutoIncrement())
+                return false;
+        }
+    }
+
+    uint8_t buffer[1 + PCA9685::MaxBurst];
+    buffer[0] = first;
+    std::memcpy(buffer + 1, values, count);
+    const bool written = _master->write(group.address, buffer, count + 1) == static_cast<int>(count + 1);
+    if (!written)
+    {
+        std::cerr << "PCA9685Array: failed to write the group address 0x" << std::hex << static_cast<unsigned>(group.address)
+                  << std::dec << std::endl;
+    }
+
+    for (const auto index : group.devices)
+    {
+        _devices[index]->groupWritten(first, values, count, written);
+    }
+    return written;
+}
+
+// The caller must hold _mutex
+bool PCA9685Array::unchanged(const GroupMembers& group, const uint8_t first, const uint8_t* values, const size_t count) const
+{
+    if (!group.defined || group.devices.empty())
+        return false;
+
+    return std::all_of(group.devices.begin(), group.devices.end(), [&](const size_t index)
+    {
+        return _devices[index]->holds(first, values, count);
+    });
+}
@@ -0,0 +1,181 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Several PCA9685 on one I2C bus driven as one channel space (device n owns the channels 16n to 16n + 15).
+    - The settings shared by many chips are sent once to a group address: the LED All Call address
+      (every device, programmed by begin()) or a subaddress group (SUB1 to SUB3, see defineGroup()).
+      The chips of the group take the write in the same transaction.
+    - The per channel updates go to their own chip, the changed registers of a chip in one burst.
+    - The shadow registers of the devices follow the group writes, an unchanged group setting isn't sent.
+
+    Every PCA9685 answering the All Call address has to be in the array (the chips answer 0x70 at power up):
+    give the other ones a different All Call address or disable it.
+
+    Exemple:
+    PCA9685Array drivers(device, { 0x40, 0x41, 0x42 });
+    drivers.begin();
+    drivers.setPwmFrequency(50);                            // 3 transactions for the 3 chips
+    drivers.defineGroup(PCA9685Array::Group::Sub1, 0x71, { 0, 2 });
+    drivers.setAll(PCA9685Array::Group::Sub1, PCA9685::dutyCountsSetting(2048));
+    drivers.setPwm(35, PCA9685::dutyCountsSetting(1024));   // Device 2, channel 3
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "I2C.h"
+#include "PCA9685.h"
+#include "export.h"
+
+namespace ioAdapter
+{
+    class IO_ADAPTER_API PCA9685Array final
+    {
+    public:
+        using Group = PCA9685::Group;
+        using PwmSetting = PCA9685::PwmSetting;
+
+        static constexpr uint8_t DefaultAllCallAddress = 0x70;
+
+        /**
+         * @brief Array of PCA9685 sharing a bus.
+         *
+         * @param master The I2C master of the bus.
+         * @param addresses The 7-bit addresses of the devices, in channel order.
+         * @param allCallAddress The LED All Call address programmed in every device.
+         */
+        PCA9685Array(const std::shared_ptr<I2C::I2CMaster>& master, const std::vector<uint8_t>& addresses,
+                     uint8_t allCallAddress = DefaultAllCallAddress);
+        // Delete the default copy constructor
+        PCA9685Array(const PCA9685Array&) = delete;
+        PCA9685Array& operator=(const PCA9685Array&) = delete;
+        // Delete the default move constructor
+        PCA9685Array(PCA9685Array&&) = delete;
+        PCA9685Array& operator=(PCA9685Array&&) = delete;
+        ~PCA9685Array() = default;
+
+        /**
+         * @brief Program the All Call address and the auto-increment of every device (one transaction per
+         *        changed register).
+         *
+         * @return True if successful, false otherwise.
+         */
+        bool begin();
+
+        size_t devicesCount() const { return _devices.size(); }
+        size_t channelsCount() const { return _devices.size() * PCA9685::ChannelsCount; }
+
+        /**
+         * @brief Get a device, for the per chip settings.
+         *
+         * @param index The device index (constructor order).
+         * @return The device, nullptr if it doesn't exist.
+         */
+        std::shared_ptr<PCA9685> device(size_t index) const;
+
+        /**
+         * @brief Make a subaddress group out of some devices (the others stop answering it).
+         *
+         * @param group Sub1, Sub2 or Sub3 (AllCall is every device).
+         * @param address The 7-bit group address.
+         * @param devices The indexes of the member devices.
+         * @return True if successful, false otherwise.
+         */
+        bool defineGroup(Group group, uint8_t address, const std::vector<size_t>& devices);
+
+        /**
+         * @brief Set one channel of the array.
+         *
+         * @param channel The channel (0 to channelsCount() - 1).
+         * @param setting The ON / OFF counts.
+         * @return True if successful (or unchanged), false otherwise.
+         */
+        bool setPwm(size_t channel, const PwmSetting& setting);
+
+        /**
+         * @brief Set several channels of the array, each device receives its changed registers in one burst.
+         *
+         * @param channels The channels (0 to channelsCount() - 1).
+         * @param settings The ON / OFF counts of each channel.
+         * @param count The number of channels.
+         * @return True if successful (or unchanged), false otherwise.
+         */
+        bool setPwm(const size_t* channels, const PwmSetting* settings, size_t count);
+
+        /**
+         * @brief Set the same channel of every device of a group in one transaction.
+         *
+         * @param group The group.
+         * @param channel The channel handle (0 to 15 on each device).
+         * @param setting The ON / OFF counts.
+         * @return True if successful (or unchanged), false otherwise.
+         */
+        bool setPwm(Group group, PCA9685::Channel channel, const PwmSetting& setting);
+
+        /**
+         * @brief Send the same 16 channels to every device of a group in one transaction.
+         *
+         * @return True if successful (or unchanged), false otherwise.
+         */
+        bool writeFrame(Group group, const PCA9685::Frame& frame);
+
+        /**
+         * @brief Load every channel of a group through the ALL_LED registers in one transaction.
+         *
+         * @return True if successful, false otherwise.
+         */
+        bool setAll(Group group, const PwmSetting& setting);
+
+        /**
+         * @brief Turn every channel of the array fully on or off (one transaction).
+         */
+        bool setAllFull(bool on);
+
+        /**
+         * @brief Set the PWM frequency of every device. PRE_SCALE is sent once to the All Call address,
+         *        MODE1 too when it's the same on every device (else one sleep / wake write per device).
+         *
+         * @param freq The frequency in Hz.
+         * @return True if successful (or unchanged), false otherwise.
+         */
+        bool setPwmFrequency(unsigned freq);
+
+    private:
+        struct GroupMembers
+        {
+            bool defined = false;
+            uint8_t address = 0;
+            std::vector<size_t> devices;
+        };
+
+        /**
+         * @brief Write consecutive registers of the group members in one transaction and update their shadow.
+         *
+         * @return True if successful, false otherwise.
+         */
+        bool broadcast(const GroupMembers& group, uint8_t first, const uint8_t* values, size_t count);
+
+        /**
+         * @brief Check if every member already holds these register values.
+         */
+        bool unchanged(const GroupMembers& group, uint8_t first, const uint8_t* values, size_t count) const;
+
+        const std::shared_ptr<I2C::I2CMaster> _master;
+        std::vector<std::shared_ptr<PCA9685>> _devices;
+        std::array<GroupMembers, 4> _groups;   // Indexed by Group
+
+        // setPwm() batch of one device, reused (no allocation per update)
+        std::vector<PCA9685::Channel> _batchChannels;
+        std::vector<PwmSetting> _batchSettings;
+        std::mutex _mutex;
+    };
+}
@@ -0,0 +1,310 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "ServoMotion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+using namespace ioAdapter;
+
+// Position reached (degrees)
+static constexpr double PositionTolerance = 1e-3;
+
+ServoMotion::ServoMotion(std::shared_ptr<PCA9685> driver, const std::chrono::microseconds updatePeriod):
+    _driver(std::move(driver)),
+    _updatePeriod(std::max(updatePeriod, std::chrono::microseconds(1000))),
+    _dt(std::chrono::duration<double>(_updatePeriod).count())
+{
+    _servos.reserve(PCA9685::ChannelsCount);
+}
+
+ServoMotion::~ServoMotion()
+{
+    stop();
+}
+
+int ServoMotion::addServo(const ServoConfig& config)
+{
+    const auto channel = PCA9685::channel(config.channel);
+    if (!channel.valid() || config.maxAngle <= config.minAngle ||
+        config.maxVelocity <= 0 || config.maxAcceleration <= 0 || config.maxJerk <= 0)
+    {
+        std::cerr << "ServoMotion: invalid servo configuration (channel " << config.channel << ")" << std::endl;
+        return -1;
+    }
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (_thread.joinable())
+    {
+        std::cerr << "ServoMotion: the servos have to be added before start()" << std::endl;
+        return -1;
+    }
+    if (std::any_of(_servos.begin(), _servos.end(), [&](const Servo& servo) { return servo.config.channel == config.channel; }))
+    {
+        std::cerr << "ServoMotion: channel " << config.channel << " already used" << std::endl;
+        return -1;
+    }
+
+    Servo servo;
+    servo.config = config;
+    servo.channel = channel;
+    servo.target = std::clamp(config.initialAngle, config.minAngle, config.maxAngle);
+    servo.position = servo.target;
+    servo.output = servo.target;
+    servo.velocityLimit = config.maxVelocity;
+    servo.accelerationLimit = config.maxAcceleration;
+
+    // SCurve: averaging over the acceleration ramp time bounds the jerk to maxAcceleration / ramp time
+    if (config.profile == Profile::SCurve)
+    {
+        const auto ramp = config.maxAcceleration / config.maxJerk;
+        servo.historyLength = std::clamp<size_t>(static_cast<size_t>(std::lround(ramp / _dt)), 1, MaxSmoothing);
+    }
+    servo.history.fill(servo.position);
+    servo.historySum = servo.position * static_cast<double>(servo.historyLength);
+
+    _servos.push_back(servo);
+    return static_cast<int>(_servos.size() - 1);
+}
+
+// The caller must hold _mutex
+bool ServoMotion::validServo(const int servo) const
+{
+    return servo >= 0 && static_cast<size_t>(servo) < _servos.size();
+}
+
+bool ServoMotion::moveTo(const int servo, const double angle)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (!validServo(servo))
+        return false;
+
+    auto& motion = _servos[servo];
+    motion.target = std::clamp(angle, motion.config.minAngle, motion.config.maxAngle);
+    motion.velocityLimit = motion.config.maxVelocity;
+    motion.accelerationLimit = motion.config.maxAcceleration;
+    return true;
+}
+
+// Duration of a trapezoidal move from rest to rest
+double ServoMotion::moveDuration(const double distance, const double velocity, const double acceleration)
+{
+    if (distance * acceleration >= velocity * velocity)
+        return distance / velocity + velocity / acceleration;
+    return 2 * std::sqrt(distance / acceleration);
+}
+
+/*
+   Stretching a profile in time by s divides its velocity by s and its acceleration by s^2:
+   every servo gets the duration of the slowest one.
+ */
+bool ServoMotion::moveSynchronized(const std::vector<Target>& targets)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& target : targets)
+    {
+        if (!validServo(target.servo))
+            return false;
+    }
+
+    double duration = 0;
+    for (const auto& target : targets)
+    {
+        const auto& servo = _servos[target.servo];
+        const auto angle = std::clamp(target.angle, servo.config.minAngle, servo.config.maxAngle);
+        duration = std::max(duration, moveDuration(std::abs(angle - servo.position), servo.config.maxVelocity,
+                                                   servo.config.maxAcceleration));
+    }
+
+    for (const auto& target : targets)
+    {
+        auto& servo = _servos[target.servo];
+        servo.target = std::clamp(target.angle, servo.config.minAngle, servo.config.maxAngle);
+        const auto own = moveDuration(std::abs(servo.target - servo.position), servo.config.maxVelocity,
+                                      servo.config.maxAcceleration);
+        const auto stretch = own > 0 ? duration / own : 1.0;
+        servo.velocityLimit = servo.config.maxVelocity / stretch;
+        servo.accelerationLimit = servo.config.maxAcceleration / (stretch * stretch);
+    }
+    return true;
+}
+
+bool ServoMotion::halt(const int servo)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (!validServo(servo))
+        return false;
+
+    // Target at the braking distance of the current velocity
+    auto& motion = _servos[servo];
+    const auto braking = motion.velocity * std::abs(motion.velocity) / (2 * motion.config.maxAcceleration);
+    motion.target = std::clamp(motion.position + braking, motion.config.minAngle, motion.config.maxAngle);
+    motion.accelerationLimit = motion.config.maxAcceleration;
+    return true;
+}
+
+double ServoMotion::angle(const int servo) const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return validServo(servo) ? _servos[servo].output : 0;
+}
+
+bool ServoMotion::isMoving(const int servo) const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (!validServo(servo))
+        return false;
+
+    const auto& motion = _servos[servo];
+    return motion.velocity != 0 || std::abs(motion.output - motion.target) > PositionTolerance;
+}
+
+bool ServoMotion::idle() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return std::none_of(_servos.begin(), _servos.end(), [](const Servo& servo)
+    {
+        return servo.velocity != 0 || std::abs(servo.output - servo.target) > PositionTolerance;
+    });
+}
+
+bool ServoMotion::waitIdle(const std::chrono::milliseconds timeout) const
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!idle())
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(_updatePeriod);
+    }
+    return true;
+}
+
+// Advance a servo by one period, the caller must hold _mutex
+void ServoMotion::step(Servo& servo) const
+{
+    const auto distance = servo.target - servo.position;
+    const auto speedStep = servo.accelerationLimit * _dt;
+
+    if (std::abs(distance) < PositionTolerance && std::abs(servo.velocity) <= speedStep)
+    {
+        servo.position = servo.target;
+        servo.velocity = 0;
+    }
+    else
+    {
+        // Fastest velocity that can still stop on the target, within the velocity limit
+        const auto stopping = std::sqrt(2 * servo.accelerationLimit * std::abs(distance));
+        const auto wanted = std::copysign(std::min(stopping, servo.velocityLimit), distance);
+        servo.velocity += std::clamp(wanted - servo.velocity, -speedStep, speedStep);
+        servo.position += servo.velocity * _dt;
+
+        // Crossed the target: the discretization is absorbed here
+        if ((servo.target - servo.position) * distance <= 0)
+        {
+            servo.position = servo.target;
+            servo.velocity = 0;
+        }
+    }
+
+    // Moving average (SCurve), a length of 1 outputs the trapezoidal setpoint
+    servo.historySum += servo.position - servo.history[servo.historyIndex];
+    servo.history[servo.historyIndex] = servo.position;
+    servo.historyIndex = (servo.historyIndex + 1) % servo.historyLength;
+    servo.output = servo.historySum / static_cast<double>(servo.historyLength);
+    if (servo.velocity == 0 && std::abs(servo.output - servo.position) < PositionTolerance)
+    {
+        servo.output = servo.position;
+    }
+}
+
+bool ServoMotion::tick()
+{
+    PCA9685::Channel channels[PCA9685::ChannelsCount];
+    PCA9685::PwmSetting settings[PCA9685::ChannelsCount];
+    size_t count = 0;
+
+    const auto prescale = _driver->prescale();
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _statistics.ticks++;
+        for (auto& servo : _servos)
+        {
+            step(servo);
+
+            const auto& config = servo.config;
+            const auto ratio = (servo.output - config.minAngle) / (config.maxAngle - config.minAngle);
+            const auto pulse = static_cast<double>(config.minPulse) +
+                               ratio * (static_cast<double>(config.maxPulse) - static_cast<double>(config.minPulse));
+            channels[count] = servo.channel;
+            settings[count] = PCA9685::dutyCountsSetting(
+                PCA9685::pulseWidthCounts(static_cast<uint32_t>(std::lround(std::max(pulse, 0.0))), prescale));
+            count++;
+        }
+    }
+
+    if (count == 0)
+        return true;
+
+    // One call for all the channels of the tick, the unchanged ones aren't sent
+    if (!_driver->setPwm(channels, settings, count))
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _statistics.writeErrors++;
+        return false;
+    }
+    return true;
+}
+
+ServoMotion::Statistics ServoMotion::statistics() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _statistics;
+}
+
+void ServoMotion::start()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (!_thread.joinable())
+    {
+        _thread = boost::thread(&ServoMotion::doWork, this);
+    }
+}
+
+void ServoMotion::stop()
+{
+    if (_thread.joinable())
+    {
+        _thread.interrupt();
+        _thread.join();
+    }
+}
+
+void ServoMotion::doWork()
+{
+    auto nextTick = std::chrono::steady_clock::now();
+    while (true)
+    {
+        boost::this_thread::interruption_point();
+
+        tick();
+
+        nextTick += _updatePeriod;
+        const auto now = std::chrono::steady_clock::now();
+        if (now - nextTick > _updatePeriod)
+        {
+            // Late by more than a period: restart the schedule instead of bursting
+            nextTick = now;
+            const std::lock_guard<std::mutex> lock(_mutex);
+            _statistics.lateTicks++;
+        }
+        boost::this_thread::sleep_for(boost::chrono::microseconds(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::max(nextTick - now, std::chrono::steady_clock::duration::zero())).count()));
+    }
+}
@@ -0,0 +1,195 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Servo trajectory engine on top of a PCA9685. The servos are given target angles, the engine thread
+    generates their trajectories within the velocity / acceleration (/ jerk) limits and streams the
+    interpolated setpoints at a fixed update rate. All the channels of a tick are sent by one
+    PCA9685::setPwm() call (changed registers only, coalesced in one burst).
+
+    Profiles:
+    - Trapezoidal: online generator, the velocity ramps at maxAcceleration up to maxVelocity and brakes to
+      stop on the target. A new target can be given at any time, the motion goes on from the current velocity.
+    - SCurve: the trapezoidal setpoints are smoothed by a moving average of maxAcceleration / maxJerk seconds,
+      the acceleration then ramps (bounded jerk) and the servo still stops exactly on the target.
+
+    Exemple:
+    ServoMotion motion(pwmDriver);
+    ServoMotion::ServoConfig pan;
+    pan.channel = 0;
+    const int panServo = motion.addServo(pan);
+    motion.start();
+    motion.moveTo(panServo, 45);
+*/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "PCA9685.h"
+#include "export.h"
+
+namespace ioAdapter
+{
+    class IO_ADAPTER_API ServoMotion final
+    {
+    public:
+        enum class Profile
+        {
+            Trapezoidal,
+            SCurve
+        };
+
+        struct ServoConfig
+        {
+            unsigned channel = 0;           // PCA9685 channel (0 to 15)
+            uint32_t minPulse = 1000;       // Pulse width at minAngle (us)
+            uint32_t maxPulse = 2000;       // Pulse width at maxAngle (us)
+            double minAngle = -90;          // Degrees
+            double maxAngle = 90;           // Degrees
+            double initialAngle = 0;        // Sent by the first tick (the servo jumps there)
+            double maxVelocity = 180;       // Degrees per second
+            double maxAcceleration = 720;   // Degrees per second^2
+            double maxJerk = 7200;          // Degrees per second^3 (SCurve)
+            Profile profile = Profile::Trapezoidal;
+        };
+
+        struct Target
+        {
+            int servo = -1;
+            double angle = 0;
+        };
+
+        struct Statistics
+        {
+            uint64_t ticks = 0;             // Updates computed
+            uint64_t lateTicks = 0;         // Updates started more than one period late
+            uint64_t writeErrors = 0;       // Failed bus writes
+        };
+
+        /**
+         * @brief Engine streaming to a PCA9685.
+         *
+         * @param driver The PWM driver (its frequency has to match the servos, usually 50 Hz).
+         * @param updatePeriod The period of the setpoints (usually the PWM period).
+         */
+        explicit ServoMotion(std::shared_ptr<PCA9685> driver,
+                             std::chrono::microseconds updatePeriod = std::chrono::microseconds(20000));
+        // Delete the default copy constructor
+        ServoMotion(const ServoMotion&) = delete;
+        ServoMotion& operator=(const ServoMotion&) = delete;
+        // Delete the default move constructor
+        ServoMotion(ServoMotion&&) = delete;
+        ServoMotion& operator=(ServoMotion&&) = delete;
+        ~ServoMotion();
+
+        /**
+         * @brief Add a servo (before start()).
+         *
+         * @param config The servo channel, range and limits.
+         * @return The servo id, -1 if the channel is invalid or already used.
+         */
+        int addServo(const ServoConfig& config);
+
+        /**
+         * @brief Move a servo within its configured limits.
+         *
+         * @param servo The servo id.
+         * @param angle The target angle, clamped to the servo range.
+         * @return True if successful, false if the servo doesn't exist.
+         */
+        bool moveTo(int servo, double angle);
+
+        /**
+         * @brief Move several servos so they start and arrive together (the faster ones are slowed down).
+         *        The servos are expected to be at rest.
+         *
+         * @param targets The servos and their target angles.
+         * @return True if successful, false if a servo doesn't exist (nothing is moved).
+         */
+        bool moveSynchronized(const std::vector<Target>& targets);
+
+        /**
+         * @brief Stop a servo as fast as its deceleration allows.
+         */
+        bool halt(int servo);
+
+        /**
+         * @brief Get the current setpoint of a servo.
+         */
+        double angle(int servo) const;
+
+        bool isMoving(int servo) const;
+        bool idle() const;
+
+        /**
+         * @brief Wait until every servo reached its target.
+         *
+         * @param timeout The maximum wait.
+         * @return True if idle, false on timeout.
+         */
+        bool waitIdle(std::chrono::milliseconds timeout) const;
+
+        /**
+         * @brief Start / stop the update thread.
+         */
+        void start();
+        void stop();
+
+        /**
+         * @brief Compute and send one update (called by the update thread, or by the application loop
+         *        when the engine isn't started).
+         *
+         * @return True if successful, false if the bus write failed.
+         */
+        bool tick();
+
+        std::chrono::microseconds updatePeriod() const { return _updatePeriod; }
+        Statistics statistics() const;
+
+    private:
+        static constexpr size_t MaxSmoothing = 32;// Moving average length (ticks)
+
+        struct Servo
+        {
+            ServoConfig config;
+            PCA9685::Channel channel;
+            double target = 0;
+            double position = 0;            // Trapezoidal setpoint
+            double velocity = 0;
+            double velocityLimit = 0;       // Limits of the current move
+            double accelerationLimit = 0;
+            // SCurve smoothing (moving average of the trapezoidal setpoints)
+            std::array<double, MaxSmoothing> history{};
+            size_t historyLength = 1;
+            size_t historyIndex = 0;
+            double historySum = 0;
+            double output = 0;
+        };
+
+        void doWork();
+        void step(Servo& servo) const;
+        bool validServo(int servo) const;
+        static double moveDuration(double distance, double velocity, double acceleration);
+
+        const std::shared_ptr<PCA9685> _driver;
+        const std::chrono::microseconds _updatePeriod;
+        const double _dt;                   // Update period in seconds
+
+        std::vector<Servo> _servos;
+        Statistics _statistics;
+        mutable std::mutex _mutex;
+
+        // Declared last: the thread uses all the other members
+        boost::thread _thread;
+    };
+}
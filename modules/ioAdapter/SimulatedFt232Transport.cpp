@@ -0,0 +1,624 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "SimulatedFt232Transport.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "MpsseCommandBuffer.h"
+
+using namespace IoAdapter;
+
+// I2C bits of a transferred byte (8 data bits + ACK)
+static constexpr uint64_t BitsPerByte = 9;
+
+SimulatedFt232Transport::SimulatedFt232Transport():
+    SimulatedFt232Transport(LatencyModel())
+{
+}
+
+SimulatedFt232Transport::SimulatedFt232Transport(const LatencyModel& latency):
+    _latency(latency),
+    _random(latency.seed)
+{
+    DeviceInfo info;
+    info.type = 8;          // FT_DEVICE_232H
+    info.id = 0x04036014;   // VID 0403, PID 6014
+    info.locationId = 0x11;
+    info.serialNumber = "FTSIM001";
+    info.description = "Single RS232-HS";
+    addChannel(info);
+}
+
+uint32_t SimulatedFt232Transport::addChannel(const DeviceInfo& info)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    auto channel = std::make_unique<Channel>();
+    channel->info = info;
+    _channels.push_back(std::move(channel));
+    return static_cast<uint32_t>(_channels.size() - 1);
+}
+
+void SimulatedFt232Transport::setConnected(const uint32_t channel, const bool connected)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (channel >= _channels.size())
+        return;
+
+    auto& simulated = *_channels[channel];
+    if (simulated.connected == connected)
+        return;
+
+    // A replugged chip comes back closed and reset, its slaves keep their registers
+    simulated.connected = connected;
+    simulated.opened = false;
+    simulated.values = 0;
+    simulated.directions = 0;
+    simulated.answers.clear();
+}
+
+void SimulatedFt232Transport::setInputs(const uint32_t channel, const uint16_t levels)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (channel < _channels.size())
+    {
+        _channels[channel]->inputs = levels;
+    }
+}
+
+uint16_t SimulatedFt232Transport::pins(const uint32_t channel) const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return channel < _channels.size() ? levels(*_channels[channel]) : 0;
+}
+
+uint16_t SimulatedFt232Transport::directions(const uint32_t channel) const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return channel < _channels.size() ? _channels[channel]->directions : 0;
+}
+
+void SimulatedFt232Transport::addI2CSlave(const uint32_t channel, const uint8_t address, const size_t registersCount)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (channel >= _channels.size() || registersCount == 0)
+        return;
+
+    Slave slave;
+    slave.registers.assign(registersCount, 0);
+    _channels[channel]->slaves[address & 0x7F] = std::move(slave);
+}
+
+void SimulatedFt232Transport::addI2CGroup(const uint32_t channel, const uint8_t address, const std::vector<uint8_t>& members)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (channel >= _channels.size())
+        return;
+
+    auto& group = _channels[channel]->groups[address & 0x7F];
+    group.clear();
+    for (const auto member : members)
+    {
+        group.push_back(member & 0x7F);
+    }
+}
+
+bool SimulatedFt232Transport::readRegisters(const uint32_t channel, const uint8_t address, const uint8_t reg, uint8_t* data, const size_t size) const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (channel >= _channels.size())
+        return false;
+
+    const auto& slaves = _channels[channel]->slaves;
+    const auto slave = slaves.find(address & 0x7F);
+    if (slave == slaves.end() || reg + size > slave->second.registers.size())
+        return false;
+
+    std::copy_n(slave->second.registers.begin() + reg, size, data);
+    return true;
+}
+
+bool SimulatedFt232Transport::writeRegisters(const uint32_t channel, const uint8_t address, const uint8_t reg, const uint8_t* data, const size_t size)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (channel >= _channels.size())
+        return false;
+
+    auto& slaves = _channels[channel]->slaves;
+    const auto slave = slaves.find(address & 0x7F);
+    if (slave == slaves.end() || reg + size > slave->second.registers.size())
+        return false;
+
+    std::copy_n(data, size, slave->second.registers.begin() + reg);
+    return true;
+}
+
+void SimulatedFt232Transport::setLatency(const LatencyModel& latency)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _latency = latency;
+    _random.seed(latency.seed);
+}
+
+SimulatedFt232Transport::LatencyModel SimulatedFt232Transport::latency() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _latency;
+}
+
+SimulatedFt232Transport::Statistics SimulatedFt232Transport::statistics() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _statistics;
+}
+
+void SimulatedFt232Transport::resetStatistics()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _statistics = Statistics();
+}
+
+void SimulatedFt232Transport::acquire()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    ++_users;
+}
+
+void SimulatedFt232Transport::release()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (_users > 0)
+    {
+        --_users;
+    }
+}
+
+Ft232Transport::Status SimulatedFt232Transport::getNumChannels(uint32_t& count)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    count = static_cast<uint32_t>(std::count_if(_channels.begin(), _channels.end(),
+                                                [](const std::unique_ptr<Channel>& channel) { return channel->connected; }));
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::getChannelInfo(const uint32_t index, DeviceInfo& info)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto channel = connectedChannel(index);
+    if (channel == nullptr)
+        return DeviceNotFound;
+
+    info = channel->info;
+    info.flags = channel->opened ? 0x01 : 0x00;// FT_FLAGS_OPENED
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::openChannel(const uint32_t index, Handle& handle)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto channel = connectedChannel(index);
+    if (channel == nullptr)
+        return DeviceNotFound;
+    if (channel->opened)
+        return DeviceNotOpened;
+
+    channel->opened = true;
+    channel->answers.clear();
+    handle = channel;
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::openEx(const OpenBy by, const std::string& value, const uint32_t locationId, Handle& handle)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto channel = std::find_if(_channels.begin(), _channels.end(), [&](const std::unique_ptr<Channel>& simulated)
+    {
+        if (!simulated->connected)
+            return false;
+        switch (by)
+        {
+        case OpenBy::Description:
+            return simulated->info.description == value;
+        case OpenBy::Location:
+            return simulated->info.locationId == locationId;
+        case OpenBy::SerialNumber:
+        default:
+            return simulated->info.serialNumber == value;
+        }
+    });
+    if (channel == _channels.end())
+        return DeviceNotFound;
+    if ((*channel)->opened)
+        return DeviceNotOpened;
+
+    (*channel)->opened = true;
+    (*channel)->answers.clear();
+    handle = channel->get();
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::getDeviceInfo(Handle handle, DeviceInfo& info)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto channel = openedChannel(handle);
+    if (channel == nullptr)
+        return InvalidHandle;
+
+    info = channel->info;
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::initChannel(Handle handle, const ChannelConfig& config)
+{
+    std::chrono::nanoseconds delay;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        const auto channel = openedChannel(handle);
+        if (channel == nullptr)
+            return InvalidHandle;
+
+        // The MPSSE is reset: C0:C7 become inputs, D0:D7 take the configured pins (SCL & SDA high otherwise)
+        channel->clockRate = config.clockRate;
+        channel->answers.clear();
+        channel->directions = 0x0003;
+        channel->values = 0x0003;
+        if (config.options & ChannelPinStateConfig)
+        {
+            channel->directions = static_cast<uint16_t>(config.pin & 0xFF);
+            channel->values = static_cast<uint16_t>(config.pin >> 8 & 0xFF);
+        }
+        channel->finalPins = config.pin >> 16;
+
+        // Reset, configuration and synchronisation commands
+        delay = charge(transferCost(_latency.roundTrip, 3));
+    }
+    spend(delay);
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::closeChannel(Handle handle)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto channel = openedChannel(handle);
+    if (channel == nullptr)
+        return InvalidHandle;
+
+    channel->opened = false;
+    channel->answers.clear();
+    channel->directions = static_cast<uint16_t>((channel->directions & 0xFF00) | (channel->finalPins & 0xFF));
+    channel->values = static_cast<uint16_t>((channel->values & 0xFF00) | (channel->finalPins >> 8 & 0xFF));
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::write(Handle handle, const uint8_t* buffer, const uint32_t size, uint32_t& written)
+{
+    written = 0;
+    std::chrono::nanoseconds delay;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        const auto channel = openedChannel(handle);
+        if (channel == nullptr)
+            return IoError;
+
+        const auto clockedBits = interpret(*channel, buffer, size);
+        written = size;
+        _statistics.writes++;
+        _statistics.bytesWritten += size;
+        delay = charge(transferCost(_latency.writeLatency, 1) + busTime(*channel, clockedBits));
+    }
+    spend(delay);
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::read(Handle handle, uint8_t* buffer, const uint32_t size, uint32_t& received)
+{
+    received = 0;
+    std::chrono::nanoseconds delay;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        const auto channel = openedChannel(handle);
+        if (channel == nullptr)
+            return IoError;
+
+        // Like FT_Read after its timeout, only the available answers are returned
+        while (received < size && !channel->answers.empty())
+        {
+            buffer[received++] = channel->answers.front();
+            channel->answers.pop_front();
+        }
+        _statistics.reads++;
+        _statistics.bytesRead += received;
+        delay = charge(transferCost(_latency.roundTrip, 1));
+    }
+    spend(delay);
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::deviceWrite(Handle handle, const uint8_t address, const uint8_t* buffer, const uint32_t size,
+                                                            uint32_t& transferred, const uint32_t options)
+{
+    transferred = 0;
+    std::chrono::nanoseconds delay;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        const auto channel = openedChannel(handle);
+        if (channel == nullptr)
+            return IoError;
+
+        const bool addressed = !(options & TransferNoAddress);
+        if (addressed)
+        {
+            channel->lastAddress = address & 0x7F;
+        }
+
+        _statistics.i2cTransactions++;
+        const auto targets = writeTargets(*channel);
+        if (targets.empty())
+        {
+            // Address not acknowledged
+            _statistics.nacks++;
+            delay = charge(transferCost(_latency.roundTrip, 1) + busTime(*channel, BitsPerByte + 2));
+        }
+        else
+        {
+            // The fast bits transfers are counted in bits
+            const uint32_t count = (options & TransferFastBits) ? (size + 7) / 8 : size;
+
+            // The members of a group all receive the same bytes
+            for (const auto slave : targets)
+            {
+                receive(*slave, buffer, count, addressed);
+            }
+            transferred = size;
+
+            // libMPSSE checks every acknowledge with its own round trip unless a fast transfer is requested
+            const uint64_t bytes = count + (addressed ? 1 : 0);
+            const bool fast = (options & (TransferFastBytes | TransferFastBits)) != 0;
+            const auto transfers = fast ? 1 : static_cast<uint32_t>(bytes);
+            const auto bits = bytes * BitsPerByte + 2;
+            delay = charge(transferCost(_latency.roundTrip, transfers) + busTime(*channel, bits));
+        }
+    }
+    spend(delay);
+    return Ok;
+}
+
+Ft232Transport::Status SimulatedFt232Transport::deviceRead(Handle handle, const uint8_t address, uint8_t* buffer, const uint32_t size,
+                                                           uint32_t& transferred, const uint32_t options)
+{
+    transferred = 0;
+    std::chrono::nanoseconds delay;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        const auto channel = openedChannel(handle);
+        if (channel == nullptr)
+            return IoError;
+
+        const bool addressed = !(options & TransferNoAddress);
+        if (addressed)
+        {
+            channel->lastAddress = address & 0x7F;
+        }
+
+        _statistics.i2cTransactions++;
+        const auto slave = channel->slaves.find(channel->lastAddress);
+        if (slave == channel->slaves.end())
+        {
+            // Address not acknowledged
+            _statistics.nacks++;
+            delay = charge(transferCost(_latency.roundTrip, 1) + busTime(*channel, BitsPerByte + 2));
+        }
+        else
+        {
+            // The fast bits transfers are counted in bits
+            const uint32_t count = (options & TransferFastBits) ? (size + 7) / 8 : size;
+
+            auto& registers = slave->second;
+            registers.pointerExpected = false;
+            for (uint32_t byte = 0; byte < count; ++byte)
+            {
+                buffer[byte] = registers.registers[registers.pointer];
+                registers.pointer = (registers.pointer + 1) % registers.registers.size();
+            }
+            transferred = size;
+
+            const uint64_t bytes = count + (addressed ? 1 : 0);
+            const bool fast = (options & (TransferFastBytes | TransferFastBits)) != 0;
+            const auto transfers = fast ? 1 : static_cast<uint32_t>(bytes);
+            const auto bits = bytes * BitsPerByte + 2;
+            delay = charge(transferCost(_latency.roundTrip, transfers) + busTime(*channel, bits));
+        }
+    }
+    spend(delay);
+    return Ok;
+}
+
+// Slaves acknowledging the current write address, the caller must hold _mutex
+std::vector<SimulatedFt232Transport::Slave*> SimulatedFt232Transport::writeTargets(Channel& channel)
+{
+    std::vector<Slave*> targets;
+    const auto slave = channel.slaves.find(channel.lastAddress);
+    if (slave != channel.slaves.end())
+    {
+        targets.push_back(&slave->second);
+    }
+
+    const auto group = channel.groups.find(channel.lastAddress);
+    if (group != channel.groups.end())
+    {
+        for (const auto member : group->second)
+        {
+            const auto memberSlave = channel.slaves.find(member);
+            if (memberSlave != channel.slaves.end())
+            {
+                targets.push_back(&memberSlave->second);
+            }
+        }
+    }
+    return targets;
+}
+
+// The caller must hold _mutex
+void SimulatedFt232Transport::receive(Slave& slave, const uint8_t* buffer, const uint32_t size, const bool addressed)
+{
+    if (addressed)
+    {
+        slave.pointerExpected = true;
+    }
+    for (uint32_t byte = 0; byte < size; ++byte)
+    {
+        if (slave.pointerExpected)
+        {
+            slave.pointer = buffer[byte] % slave.registers.size();
+            slave.pointerExpected = false;
+        }
+        else
+        {
+            slave.registers[slave.pointer] = buffer[byte];
+            slave.pointer = (slave.pointer + 1) % slave.registers.size();
+        }
+    }
+}
+
+// The caller must hold _mutex
+SimulatedFt232Transport::Channel* SimulatedFt232Transport::openedChannel(Handle handle)
+{
+    const auto channel = std::find_if(_channels.begin(), _channels.end(),
+                                      [handle](const std::unique_ptr<Channel>& simulated) { return simulated.get() == handle; });
+    if (channel == _channels.end() || !(*channel)->connected || !(*channel)->opened)
+        return nullptr;
+    return channel->get();
+}
+
+// The caller must hold _mutex, the index counts the connected channels only (like the driver list)
+SimulatedFt232Transport::Channel* SimulatedFt232Transport::connectedChannel(const uint32_t index)
+{
+    uint32_t connected = 0;
+    for (const auto& channel : _channels)
+    {
+        if (channel->connected && connected++ == index)
+            return channel.get();
+    }
+    return nullptr;
+}
+
+uint16_t SimulatedFt232Transport::levels(const Channel& channel) const
+{
+    // Outputs read back their driven value, inputs the level set by the outside
+    return static_cast<uint16_t>((channel.values & channel.directions) | (channel.inputs & ~channel.directions));
+}
+
+/*
+   Execute the MPSSE commands of a USB write, the answers are queued for the next reads.
+   Return the number of clocked bits (0x8E / 0x8F) so the write lasts their bus time.
+ */
+uint64_t SimulatedFt232Transport::interpret(Channel& channel, const uint8_t* buffer, const uint32_t size)
+{
+    uint64_t clockedBits = 0;
+    uint32_t position = 0;
+    while (position < size)
+    {
+        const uint8_t opcode = buffer[position++];
+        const uint32_t parameters = size - position;
+        switch (static_cast<MpsseCommand>(opcode))
+        {
+        case MpsseCommand::SetDataBitsLowbyte:
+        case MpsseCommand::SetDataBitsHighbyte:
+            {
+                if (parameters < 2)
+                    return clockedBits;
+                const int shift = opcode == static_cast<uint8_t>(MpsseCommand::SetDataBitsHighbyte) ? 8 : 0;
+                const auto mask = static_cast<uint16_t>(0xFF << shift);
+                channel.values = static_cast<uint16_t>((channel.values & ~mask) | buffer[position] << shift);
+                channel.directions = static_cast<uint16_t>((channel.directions & ~mask) | buffer[position + 1] << shift);
+                position += 2;
+            }
+            break;
+        case MpsseCommand::GetDataBitsLowbyte:
+            channel.answers.push_back(static_cast<uint8_t>(levels(channel) & 0xFF));
+            break;
+        case MpsseCommand::GetDataBitsHighbyte:
+            channel.answers.push_back(static_cast<uint8_t>(levels(channel) >> 8 & 0xFF));
+            break;
+        case MpsseCommand::ClockBitsNoData:
+            if (parameters < 1)
+                return clockedBits;
+            clockedBits += buffer[position] + 1ULL;
+            position += 1;
+            break;
+        case MpsseCommand::ClockBytesNoData:
+            if (parameters < 2)
+                return clockedBits;
+            clockedBits += ((buffer[position] | buffer[position + 1] << 8) + 1ULL) * 8;
+            position += 2;
+            break;
+        case MpsseCommand::SetClockDivisor:
+            if (parameters < 2)
+                return clockedBits;
+            position += 2;
+            break;
+        case MpsseCommand::SendImmediate:
+        case MpsseCommand::LoopbackEnable:
+        case MpsseCommand::LoopbackDisable:
+        case MpsseCommand::WaitOnIoHigh:
+        case MpsseCommand::WaitOnIoLow:
+        case MpsseCommand::DisableClockDivide5:
+        case MpsseCommand::EnableClockDivide5:
+        case MpsseCommand::Enable3PhaseClocking:
+        case MpsseCommand::Disable3PhaseClocking:
+        case MpsseCommand::DisableAdaptiveClocking:
+            break;
+        default:
+            // Bad command: the MPSSE answers 0xFA followed by the opcode and drops the rest of the write
+            channel.answers.push_back(0xFA);
+            channel.answers.push_back(opcode);
+            return clockedBits;
+        }
+    }
+    return clockedBits;
+}
+
+// The caller must hold _mutex
+std::chrono::nanoseconds SimulatedFt232Transport::transferCost(const std::chrono::microseconds latency, const uint32_t transfers)
+{
+    _statistics.usbTransfers += transfers;
+
+    std::chrono::nanoseconds cost(0);
+    for (uint32_t transfer = 0; transfer < transfers; ++transfer)
+    {
+        cost += latency;
+        if (_latency.jitter.count() > 0)
+        {
+            std::uniform_int_distribution<int64_t> jitter(0, std::chrono::nanoseconds(_latency.jitter).count());
+            cost += std::chrono::nanoseconds(jitter(_random));
+        }
+    }
+    return cost;
+}
+
+std::chrono::nanoseconds SimulatedFt232Transport::busTime(const Channel& channel, const uint64_t bits) const
+{
+    if (channel.clockRate == 0)
+        return std::chrono::nanoseconds(0);
+    return std::chrono::nanoseconds(bits * 1000000000ULL / channel.clockRate);
+}
+
+// The caller must hold _mutex, return the delay to sleep (none on the virtual clock)
+std::chrono::nanoseconds SimulatedFt232Transport::charge(const std::chrono::nanoseconds cost)
+{
+    _statistics.elapsed += cost;
+    return _latency.realTime ? cost : std::chrono::nanoseconds(0);
+}
+
+void SimulatedFt232Transport::spend(const std::chrono::nanoseconds delay)
+{
+    // Slept outside of _mutex so several simulated adapters run concurrently
+    if (delay.count() > 0)
+    {
+        std::this_thread::sleep_for(delay);
+    }
+}
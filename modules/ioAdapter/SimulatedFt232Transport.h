@@ -0,0 +1,201 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    In-process FT232H used without the physical adapter (Linux build boxes, benchmarks):
+    - The MPSSE GPIO opcodes (0x80:0x83, 0x87, 0x8E, 0x8F ...) are interpreted on the D and C ports,
+      the input levels are driven by setInputs().
+    - I2C slaves are modeled as register maps with an auto-incremented register pointer: the first
+      written byte of a transaction selects the register, the next ones are written from there.
+      A group address (PCA9685 subaddress / LED All Call) forwards the writes to its member slaves.
+    - Every USB transfer costs the modeled latency plus a seeded uniform jitter, the I2C transactions
+      add their bus time. The delays are slept (realTime) or only accumulated on a virtual clock.
+
+    Exemple:
+    auto transport = std::make_shared<SimulatedFt232Transport>();
+    transport->addI2CSlave(0, 0x40);
+    FT232_MPSSE device(FT232_MPSSE::ChannelSelector::byIndex(0), FT232_MPSSE::OpenMode::Fast, transport);
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "Ft232Transport.h"
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API SimulatedFt232Transport final : public Ft232Transport
+    {
+    public:
+        /**
+         * @brief Cost of the USB transfers.
+         */
+        struct LatencyModel
+        {
+            std::chrono::microseconds writeLatency{ 60 };  // USB OUT transfer of a command buffer
+            std::chrono::microseconds roundTrip{ 250 };    // Command to answer round trip (FT_Read, per-byte I2C acknowledge)
+            std::chrono::microseconds jitter{ 0 };         // Uniform extra delay in [0, jitter] per transfer
+            uint32_t seed = 1;                             // Jitter generator seed (reproducible runs)
+            bool realTime = true;                          // Sleep the delays, otherwise only the virtual clock advances
+        };
+
+        struct Statistics
+        {
+            uint64_t writes = 0;                      // USB OUT transfers
+            uint64_t reads = 0;                       // USB IN transfers (round trips)
+            uint64_t bytesWritten = 0;
+            uint64_t bytesRead = 0;
+            uint64_t i2cTransactions = 0;
+            uint64_t usbTransfers = 0;                // All the USB transfers, I2C acknowledge round trips included
+            uint64_t nacks = 0;                       // Transactions addressed to a missing slave
+            std::chrono::nanoseconds elapsed{ 0 };    // Modeled time (USB latency + bus time)
+        };
+
+        /**
+         * @brief Simulator with one connected FT232H (channel 0).
+         */
+        SimulatedFt232Transport();
+        explicit SimulatedFt232Transport(const LatencyModel& latency);
+        // Delete the default copy constructor
+        SimulatedFt232Transport(const SimulatedFt232Transport&) = delete;
+        SimulatedFt232Transport& operator=(const SimulatedFt232Transport&) = delete;
+        // Delete the default move constructor
+        SimulatedFt232Transport(SimulatedFt232Transport&&) = delete;
+        SimulatedFt232Transport& operator=(SimulatedFt232Transport&&) = delete;
+        ~SimulatedFt232Transport() override = default;
+
+        /**
+         * @brief Plug another channel.
+         *
+         * @param info The channel as listed by the driver.
+         * @return The simulator channel number.
+         */
+        uint32_t addChannel(const DeviceInfo& info);
+
+        /**
+         * @brief Plug or unplug a channel, the opened handles fail until the channel is reopened.
+         */
+        void setConnected(uint32_t channel, bool connected);
+
+        /**
+         * @brief Set the levels driven by the outside on the input pins (D0:D7 bits 0-7, C0:C7 bits 8-15).
+         */
+        void setInputs(uint32_t channel, uint16_t levels);
+
+        /**
+         * @brief Get the levels of the pins as read by the MPSSE.
+         */
+        uint16_t pins(uint32_t channel) const;
+
+        /**
+         * @brief Get the directions of the pins (1 = output).
+         */
+        uint16_t directions(uint32_t channel) const;
+
+        /**
+         * @brief Connect an I2C slave to the bus of a channel.
+         *
+         * @param channel The simulator channel number.
+         * @param address The 7-bit slave address.
+         * @param registersCount The size of the register map.
+         */
+        void addI2CSlave(uint32_t channel, uint8_t address, size_t registersCount = 256);
+
+        /**
+         * @brief Make slaves accept the writes sent to a group address (their reads aren't acknowledged).
+         *
+         * @param channel The simulator channel number.
+         * @param address The 7-bit group address.
+         * @param members The addresses of the slaves answering it.
+         */
+        void addI2CGroup(uint32_t channel, uint8_t address, const std::vector<uint8_t>& members);
+
+        /**
+         * @brief Access the register map of a slave.
+         *
+         * @return True if successful, false if the slave or the registers don't exist.
+         */
+        bool readRegisters(uint32_t channel, uint8_t address, uint8_t reg, uint8_t* data, size_t size) const;
+        bool writeRegisters(uint32_t channel, uint8_t address, uint8_t reg, const uint8_t* data, size_t size);
+
+        void setLatency(const LatencyModel& latency);
+        LatencyModel latency() const;
+
+        Statistics statistics() const;
+        void resetStatistics();
+
+        //Ft232Transport interface
+        void acquire() override;
+        void release() override;
+
+        Status getNumChannels(uint32_t& count) override;
+        Status getChannelInfo(uint32_t index, DeviceInfo& info) override;
+        Status openChannel(uint32_t index, Handle& handle) override;
+        Status openEx(OpenBy by, const std::string& value, uint32_t locationId, Handle& handle) override;
+        Status getDeviceInfo(Handle handle, DeviceInfo& info) override;
+        Status initChannel(Handle handle, const ChannelConfig& config) override;
+        Status closeChannel(Handle handle) override;
+
+        Status write(Handle handle, const uint8_t* buffer, uint32_t size, uint32_t& written) override;
+        Status read(Handle handle, uint8_t* buffer, uint32_t size, uint32_t& received) override;
+
+        Status deviceWrite(Handle handle, uint8_t address, const uint8_t* buffer, uint32_t size,
+                           uint32_t& transferred, uint32_t options) override;
+        Status deviceRead(Handle handle, uint8_t address, uint8_t* buffer, uint32_t size,
+                          uint32_t& transferred, uint32_t options) override;
+
+    private:
+        struct Slave
+        {
+            std::vector<uint8_t> registers;
+            size_t pointer = 0;
+            bool pointerExpected = false;   // The next written byte selects the register
+        };
+
+        struct Channel
+        {
+            DeviceInfo info;
+            bool connected = true;
+            bool opened = false;
+            uint32_t clockRate = ClockStandardMode;
+            uint32_t finalPins = 0;          // BIT23-16 of ChannelConfig.Pin applied on close
+            uint16_t values = 0;
+            uint16_t directions = 0;
+            uint16_t inputs = 0;
+            std::deque<uint8_t> answers;
+            std::map<uint8_t, Slave> slaves;
+            std::map<uint8_t, std::vector<uint8_t>> groups;
+            uint8_t lastAddress = 0;         // Slave of the TransferNoAddress transfers
+        };
+
+        Channel* openedChannel(Handle handle);
+        Channel* connectedChannel(uint32_t index);
+        uint16_t levels(const Channel& channel) const;
+        uint64_t interpret(Channel& channel, const uint8_t* buffer, uint32_t size);
+        static std::vector<Slave*> writeTargets(Channel& channel);
+        static void receive(Slave& slave, const uint8_t* buffer, uint32_t size, bool addressed);
+        std::chrono::nanoseconds transferCost(std::chrono::microseconds latency, uint32_t transfers);
+        std::chrono::nanoseconds busTime(const Channel& channel, uint64_t bits) const;
+        std::chrono::nanoseconds charge(std::chrono::nanoseconds cost);
+        static void spend(std::chrono::nanoseconds delay);
+
+        mutable std::mutex _mutex;
+        std::vector<std::unique_ptr<Channel>> _channels;
+        LatencyModel _latency;
+        std::mt19937 _random;
+        Statistics _statistics;
+        unsigned _users = 0;
+    };
+}
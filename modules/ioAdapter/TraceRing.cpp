@@ -0,0 +1,122 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "TraceRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "Ft232Transport.h"
+
+using namespace IoAdapter;
+
+// The thread id hash is computed once per thread
+static uint32_t currentThread()
+{
+    thread_local const auto thread = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return thread;
+}
+
+std::shared_ptr<TraceRing> TraceRing::create(const std::string& path, const uint64_t capacity)
+{
+    if (capacity == 0)
+    {
+        std::cerr << "TraceRing: the capacity can't be 0" << std::endl;
+        return nullptr;
+    }
+
+    const auto fileSize = sizeof(TraceFileHeader) + capacity * sizeof(TraceRecord);
+    {
+        // Sized once, the pages are then only written through the mapping
+        std::filebuf file;
+        if (!file.open(path, std::ios_base::in | std::ios_base::out | std::ios_base::trunc | std::ios_base::binary))
+        {
+            std::cerr << "TraceRing: can't create " << path << std::endl;
+            return nullptr;
+        }
+        file.pubseekoff(static_cast<std::streamoff>(fileSize - 1), std::ios_base::beg);
+        file.sputc(0);
+    }
+
+    std::shared_ptr<TraceRing> ring(new TraceRing());
+    try
+    {
+        const boost::interprocess::file_mapping mapping(path.c_str(), boost::interprocess::read_write);
+        ring->_region = std::make_unique<boost::interprocess::mapped_region>(mapping, boost::interprocess::read_write,
+                                                                             0, fileSize);
+    }
+    catch (const boost::interprocess::interprocess_exception& e)
+    {
+        std::cerr << "TraceRing: can't map " << path << " (" << e.what() << ")" << std::endl;
+        return nullptr;
+    }
+
+    auto* base = static_cast<uint8_t*>(ring->_region->get_address());
+    std::memset(base, 0, fileSize);
+    ring->_header = new (base) TraceFileHeader();
+    ring->_records = reinterpret_cast<TraceRecord*>(base + sizeof(TraceFileHeader));
+
+    std::memcpy(ring->_header->magic, TraceFileHeader::Magic, sizeof(TraceFileHeader::Magic));
+    ring->_header->version = TraceFileHeader::Version;
+    ring->_header->recordSize = sizeof(TraceRecord);
+    ring->_header->capacity = capacity;
+    ring->_header->startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    ring->_header->head.store(0);
+    ring->_start = std::chrono::steady_clock::now();
+    return ring;
+}
+
+TraceRing::~TraceRing()
+{
+    if (_region)
+    {
+        _region->flush();
+    }
+}
+
+void TraceRing::record(const TraceKind kind, const uint8_t address, const uint32_t options, const uint8_t* data,
+                       const uint32_t size, const uint32_t transferred, const uint32_t status)
+{
+    const auto sequence = _header->head.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = _records[sequence % _header->capacity];
+
+    // Unpublish the slot while it is overwritten
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - _start).count());
+    slot.thread = currentThread();
+    slot.status = status;
+    slot.size = size;
+    slot.transferred = transferred;
+    slot.options = options;
+    slot.kind = kind;
+    slot.address = address;
+    // The answers are only valid up to the transferred bytes
+    auto available = (kind == TraceKind::Read || kind == TraceKind::DeviceRead) ? transferred : size;
+    if ((kind == TraceKind::DeviceWrite || kind == TraceKind::DeviceRead) && (options & Ft232Transport::TransferFastBits))
+    {
+        // Counted in bits
+        available = (available + 7) / 8;
+    }
+    slot.dataSize = data != nullptr ? static_cast<uint8_t>(std::min<size_t>(available, TraceRecord::DataCapacity)) : 0;
+    if (slot.dataSize > 0)
+    {
+        std::memcpy(slot.data, data, slot.dataSize);
+    }
+
+    slot.sequence.store(sequence + 1, std::memory_order_release);
+}
@@ -0,0 +1,134 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Binary trace of the FT232H transactions in a fixed-size memory-mapped ring file. A record is a
+    fixed 128 bytes slot claimed by an atomic increment and filled in the mapped pages: no lock and no
+    system call on the I/O paths, the OS writes the pages back to the file (kept after a crash).
+    When the ring is full the oldest records are overwritten.
+
+    File layout:
+    +---------------------------+---------------------------------------------+
+    | TraceFileHeader (64 B)    | magic, version, capacity, start time, head  |
+    | TraceRecord[capacity]     | slot = sequence % capacity                  |
+    +---------------------------+---------------------------------------------+
+
+    A slot is published by storing its sequence + 1 last, 0 means the slot is being written.
+    The traceDecoder tool turns a ring file into readable MPSSE / I2C traffic.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "export.h"
+
+namespace boost
+{
+    namespace interprocess
+    {
+        class mapped_region;
+    }
+}
+
+namespace IoAdapter
+{
+    enum class TraceKind : uint8_t
+    {
+        Write = 1,      // FT_Write: data = MPSSE commands
+        Read,           // FT_Read: data = MPSSE answers
+        DeviceWrite,    // I2C_DeviceWrite: data = written bytes
+        DeviceRead,     // I2C_DeviceRead: data = read bytes
+        Open,           // address = 0: I2C_OpenChannel (size = index), 1 + OpenBy: FT_OpenEx (data = serial number / description, options = location)
+        Init,           // I2C_InitChannel: size = clock rate, transferred = pin, address = latency timer, options = channel options
+        Close           // I2C_CloseChannel
+    };
+
+    struct TraceRecord
+    {
+        static constexpr size_t DataCapacity = 88;
+
+        std::atomic<uint64_t> sequence;     // Sequence + 1 once published, 0 while written
+        uint64_t timestamp;                 // ns since the ring start
+        uint32_t thread;                    // Hash of the calling thread id
+        uint32_t status;                    // FT_STATUS
+        uint32_t size;                      // Requested bytes
+        uint32_t transferred;               // Transferred bytes
+        uint32_t options;                   // I2C transfer options
+        TraceKind kind;
+        uint8_t address;                    // I2C slave address
+        uint8_t dataSize;                   // Bytes kept in data (the transfer may be longer)
+        uint8_t reserved;
+        uint8_t data[DataCapacity];
+    };
+
+    struct TraceFileHeader
+    {
+        static constexpr char Magic[8] = { 'F', 'T', 'T', 'R', 'A', 'C', 'E', '1' };
+        static constexpr uint32_t Version = 1;
+
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t capacity;                  // Number of records
+        int64_t startTime;                  // system_clock ns since the epoch at the ring start
+        std::atomic<uint64_t> head;         // Next sequence
+        uint8_t reserved[24];
+    };
+
+    static_assert(sizeof(TraceRecord) == 128, "The trace file layout changed");
+    static_assert(sizeof(TraceFileHeader) == 64, "The trace file layout changed");
+
+    class IO_ADAPTER_API TraceRing final
+    {
+    public:
+        /**
+         * @brief Create (or truncate) a ring file and map it.
+         *
+         * @param path The ring file.
+         * @param capacity The number of records (128 bytes each).
+         * @return The ring, nullptr if the file can't be created or mapped.
+         */
+        static std::shared_ptr<TraceRing> create(const std::string& path, uint64_t capacity);
+
+        // Delete the default copy constructor
+        TraceRing(const TraceRing&) = delete;
+        TraceRing& operator=(const TraceRing&) = delete;
+        // Delete the default move constructor
+        TraceRing(TraceRing&&) = delete;
+        TraceRing& operator=(TraceRing&&) = delete;
+        ~TraceRing();
+
+        /**
+         * @brief Append a record, the oldest one is overwritten when the ring is full.
+         *
+         * @param kind The transaction.
+         * @param address The I2C slave address (I2C transactions).
+         * @param options The I2C transfer options (I2C transactions).
+         * @param data The transferred bytes, only the first DataCapacity are kept.
+         * @param size The requested bytes.
+         * @param transferred The transferred bytes.
+         * @param status The transaction status.
+         */
+        void record(TraceKind kind, uint8_t address, uint32_t options, const uint8_t* data, uint32_t size,
+                    uint32_t transferred, uint32_t status);
+
+        uint64_t capacity() const { return _header->capacity; }
+        uint64_t recorded() const { return _header->head.load(std::memory_order_relaxed); }
+
+    private:
+        TraceRing() = default;
+
+        std::unique_ptr<boost::interprocess::mapped_region> _region;
+        TraceFileHeader* _header = nullptr;
+        TraceRecord* _records = nullptr;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
@@ -0,0 +1,126 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "TracingTransport.h"
+
+using namespace IoAdapter;
+
+TracingTransport::TracingTransport(std::shared_ptr<Ft232Transport> transport, std::shared_ptr<TraceRing> ring):
+    _transport(std::move(transport)),
+    _ring(std::move(ring))
+{
+}
+
+void TracingTransport::acquire()
+{
+    _transport->acquire();
+}
+
+void TracingTransport::release()
+{
+    _transport->release();
+}
+
+Ft232Transport::Status TracingTransport::getNumChannels(uint32_t& count)
+{
+    return _transport->getNumChannels(count);
+}
+
+Ft232Transport::Status TracingTransport::getChannelInfo(const uint32_t index, DeviceInfo& info)
+{
+    return _transport->getChannelInfo(index, info);
+}
+
+Ft232Transport::Status TracingTransport::openChannel(const uint32_t index, Handle& handle)
+{
+    const auto status = _transport->openChannel(index, handle);
+    if (tracing())
+    {
+        _ring->record(TraceKind::Open, 0, 0, nullptr, index, 0, status);
+    }
+    return status;
+}
+
+Ft232Transport::Status TracingTransport::openEx(const OpenBy by, const std::string& value, const uint32_t locationId,
+                                                Handle& handle)
+{
+    const auto status = _transport->openEx(by, value, locationId, handle);
+    if (tracing())
+    {
+        _ring->record(TraceKind::Open, static_cast<uint8_t>(1 + static_cast<int>(by)), locationId,
+                      reinterpret_cast<const uint8_t*>(value.data()), static_cast<uint32_t>(value.size()), 0, status);
+    }
+    return status;
+}
+
+Ft232Transport::Status TracingTransport::getDeviceInfo(const Handle handle, DeviceInfo& info)
+{
+    return _transport->getDeviceInfo(handle, info);
+}
+
+Ft232Transport::Status TracingTransport::initChannel(const Handle handle, const ChannelConfig& config)
+{
+    const auto status = _transport->initChannel(handle, config);
+    if (tracing())
+    {
+        _ring->record(TraceKind::Init, config.latencyTimer, config.options, nullptr, config.clockRate, config.pin, status);
+    }
+    return status;
+}
+
+Ft232Transport::Status TracingTransport::closeChannel(const Handle handle)
+{
+    const auto status = _transport->closeChannel(handle);
+    if (tracing())
+    {
+        _ring->record(TraceKind::Close, 0, 0, nullptr, 0, 0, status);
+    }
+    return status;
+}
+
+Ft232Transport::Status TracingTransport::write(const Handle handle, const uint8_t* buffer, const uint32_t size,
+                                               uint32_t& written)
+{
+    const auto status = _transport->write(handle, buffer, size, written);
+    if (tracing())
+    {
+        _ring->record(TraceKind::Write, 0, 0, buffer, size, written, status);
+    }
+    return status;
+}
+
+Ft232Transport::Status TracingTransport::read(const Handle handle, uint8_t* buffer, const uint32_t size,
+                                              uint32_t& received)
+{
+    const auto status = _transport->read(handle, buffer, size, received);
+    if (tracing())
+    {
+        _ring->record(TraceKind::Read, 0, 0, buffer, size, received, status);
+    }
+    return status;
+}
+
+Ft232Transport::Status TracingTransport::deviceWrite(const Handle handle, const uint8_t address, const uint8_t* buffer,
+                                                     const uint32_t size, uint32_t& transferred, const uint32_t options)
+{
+    const auto status = _transport->deviceWrite(handle, address, buffer, size, transferred, options);
+    if (tracing())
+    {
+        _ring->record(TraceKind::DeviceWrite, address, options, buffer, size, transferred, status);
+    }
+    return status;
+}
+
+Ft232Transport::Status TracingTransport::deviceRead(const Handle handle, const uint8_t address, uint8_t* buffer,
+                                                    const uint32_t size, uint32_t& transferred, const uint32_t options)
+{
+    const auto status = _transport->deviceRead(handle, address, buffer, size, transferred, options);
+    if (tracing())
+    {
+        _ring->record(TraceKind::DeviceRead, address, options, buffer, size, transferred, status);
+    }
+    return status;
+}
@@ -0,0 +1,77 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Opt-in tracing decorator of an FT232H transport: every call is forwarded to the traced transport and
+    recorded (timestamp, thread, sent/answered bytes, status) in a TraceRing while tracing is enabled.
+
+    Exemple:
+    auto ring = TraceRing::create("ft232h.trace", 65536);
+    auto transport = std::make_shared<TracingTransport>(std::make_shared<FtdiTransport>(), ring);
+    FT232_MPSSE device(FT232_MPSSE::ChannelSelector::byIndex(0), FT232_MPSSE::OpenMode::Fast, transport);
+    ...
+    traceDecoder ft232h.trace
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "Ft232Transport.h"
+#include "TraceRing.h"
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API TracingTransport final : public Ft232Transport
+    {
+    public:
+        /**
+         * @brief Trace a transport, tracing is enabled.
+         *
+         * @param transport The traced transport.
+         * @param ring The ring the transactions are recorded in.
+         */
+        TracingTransport(std::shared_ptr<Ft232Transport> transport, std::shared_ptr<TraceRing> ring);
+        // Delete the default copy constructor
+        TracingTransport(const TracingTransport&) = delete;
+        TracingTransport& operator=(const TracingTransport&) = delete;
+        // Delete the default move constructor
+        TracingTransport(TracingTransport&&) = delete;
+        TracingTransport& operator=(TracingTransport&&) = delete;
+        ~TracingTransport() override = default;
+
+        void setEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+        bool enabled() const { return _enabled.load(std::memory_order_relaxed); }
+        const std::shared_ptr<TraceRing>& ring() const { return _ring; }
+
+        void acquire() override;
+        void release() override;
+
+        Status getNumChannels(uint32_t& count) override;
+        Status getChannelInfo(uint32_t index, DeviceInfo& info) override;
+        Status openChannel(uint32_t index, Handle& handle) override;
+        Status openEx(OpenBy by, const std::string& value, uint32_t locationId, Handle& handle) override;
+        Status getDeviceInfo(Handle handle, DeviceInfo& info) override;
+        Status initChannel(Handle handle, const ChannelConfig& config) override;
+        Status closeChannel(Handle handle) override;
+
+        Status write(Handle handle, const uint8_t* buffer, uint32_t size, uint32_t& written) override;
+        Status read(Handle handle, uint8_t* buffer, uint32_t size, uint32_t& received) override;
+
+        Status deviceWrite(Handle handle, uint8_t address, const uint8_t* buffer, uint32_t size,
+                           uint32_t& transferred, uint32_t options) override;
+        Status deviceRead(Handle handle, uint8_t address, uint8_t* buffer, uint32_t size,
+                          uint32_t& transferred, uint32_t options) override;
+
+    private:
+        bool tracing() const { return _ring != nullptr && _enabled.load(std::memory_order_relaxed); }
+
+        const std::shared_ptr<Ft232Transport> _transport;
+        const std::shared_ptr<TraceRing> _ring;
+        std::atomic<bool> _enabled{ true };
+    };
+}
@@ -0,0 +1,80 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "Waveform.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Bitwise.h"
+
+using namespace IoAdapter;
+
+Waveform& Waveform::set(const io::inOut::Port port, const uint8_t value, const uint8_t mask, const std::chrono::nanoseconds hold)
+{
+    _steps.push_back({ port, value, mask, hold });
+    return *this;
+}
+
+// Port and bit of a GPIO pin, C8 & C9 are not controllable as GPIO pins in MPSSE mode
+bool Waveform::portPin(const io::inOut::Gpio gpio, io::inOut::Port& port, uint8_t& mask)
+{
+    if (static_cast<int>(gpio) < 0 || static_cast<int>(gpio) > static_cast<int>(io::inOut::Gpio::C7))
+    {
+        std::cerr << "Waveform: pin " << static_cast<int>(gpio) << " can't be played" << std::endl;
+        _valid = false;
+        return false;
+    }
+
+    port = static_cast<int>(gpio) > 7 ? io::inOut::Port::C : io::inOut::Port::D;
+    mask = static_cast<uint8_t>(Bitwise::shift(static_cast<int>(gpio) % 8));
+    return true;
+}
+
+Waveform& Waveform::pulse(const io::inOut::Gpio gpio, const std::chrono::nanoseconds width, const io::inOut::GpioState active)
+{
+    io::inOut::Port port;
+    uint8_t mask = 0;
+    if (!portPin(gpio, port, mask))
+        return *this;
+
+    const uint8_t activeValue = active == io::inOut::GpioState::High ? mask : 0x00;
+
+    set(port, activeValue, mask, width);
+    return set(port, static_cast<uint8_t>(~activeValue & mask), mask, std::chrono::nanoseconds(0));
+}
+
+Waveform& Waveform::pwm(const io::inOut::Gpio gpio, const std::chrono::nanoseconds period, const double dutyCycle, const unsigned cycles)
+{
+    io::inOut::Port port;
+    uint8_t mask = 0;
+    if (!portPin(gpio, port, mask))
+        return *this;
+
+    const auto high = std::chrono::nanoseconds(static_cast<int64_t>(period.count() * std::clamp(dutyCycle, 0.0, 100.0) / 100));
+
+    for (unsigned cycle = 0; cycle < cycles; ++cycle)
+    {
+        set(port, mask, mask, high);
+        set(port, 0x00, mask, period - high);
+    }
+    return *this;
+}
+
+Waveform& Waveform::delay(const std::chrono::nanoseconds hold)
+{
+    return set(io::inOut::Port::C, 0x00, 0x00, hold);
+}
+
+std::chrono::nanoseconds Waveform::duration() const
+{
+    std::chrono::nanoseconds duration(0);
+    for (const auto& step : _steps)
+    {
+        duration += step.hold;
+    }
+    return duration;
+}
@@ -0,0 +1,104 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Pulse train played by the FT232H MPSSE engine (see FT232_MPSSE::playWaveform).
+    Each step sets some pins of a port then holds them for a given time. The steps are compiled into GPIO set
+    commands (0x80 / 0x82) separated by "clock for n bits with no data" commands (0x8E / 0x8F), the whole train
+    is sent in one USB write and timed by the MPSSE clock, not by the host. A train whose commands don't fit
+    in one MPSSE command buffer (4 KB, 3 to 8 bytes per step) is refused.
+
+    Exemple (10 us strobe on C2 followed by 3 PWM cycles on C3):
+        Waveform waveform;
+        waveform.pulse(inOut::Gpio::C2, std::chrono::microseconds(10))
+                .pwm(inOut::Gpio::C3, std::chrono::microseconds(100), 25, 3);
+        device->playWaveform(waveform);
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "inout.h"
+#include "export.h"
+
+namespace IoAdapter
+{
+    class IO_ADAPTER_API Waveform final
+    {
+    public:
+        struct Step
+        {
+            io::inOut::Port port;
+            uint8_t value;                // Pins values (bit n --> pin n of the port)
+            uint8_t mask;                 // Pins updated by the step
+            std::chrono::nanoseconds hold;// Time before the next step
+        };
+
+        /**
+         * @brief Append a step.
+         *
+         * @param port The GPIO port.
+         * @param value The pins values.
+         * @param mask The pins to update.
+         * @param hold The time to hold the values before the next step.
+         * @return The waveform.
+         */
+        Waveform& set(io::inOut::Port port, uint8_t value, uint8_t mask, std::chrono::nanoseconds hold);
+
+        /**
+         * @brief Append a pulse: the pin is driven to 'active' during 'width' then back to the opposite state.
+         *
+         * @param gpio The GPIO pin (D4:C7), C8 / C9 make the waveform invalid.
+         * @param width The pulse width.
+         * @param active The pulse state.
+         * @return The waveform.
+         */
+        Waveform& pulse(io::inOut::Gpio gpio, std::chrono::nanoseconds width,
+                        io::inOut::GpioState active = io::inOut::GpioState::High);
+
+        /**
+         * @brief Append software PWM cycles.
+         *
+         * @param gpio The GPIO pin (D4:C7), C8 / C9 make the waveform invalid.
+         * @param period The PWM period.
+         * @param dutyCycle The duty cycle (0 to 100 %).
+         * @param cycles The number of periods.
+         * @return The waveform.
+         */
+        Waveform& pwm(io::inOut::Gpio gpio, std::chrono::nanoseconds period, double dutyCycle, unsigned cycles);
+
+        /**
+         * @brief Append a delay without changing the pins.
+         *
+         * @param hold The delay.
+         * @return The waveform.
+         */
+        Waveform& delay(std::chrono::nanoseconds hold);
+
+        void clear()
+        {
+            _steps.clear();
+            _valid = true;
+        }
+
+        /**
+         * @brief Check that every pin given to the waveform can be played (invalid waveforms are refused).
+         */
+        bool valid() const { return _valid; }
+
+        const std::vector<Step>& steps() const { return _steps; }
+
+        std::chrono::nanoseconds duration() const;
+
+    private:
+        bool portPin(io::inOut::Gpio gpio, io::inOut::Port& port, uint8_t& mask);
+
+        std::vector<Step> _steps;
+        bool _valid = true;
+    };
+}
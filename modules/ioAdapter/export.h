@@ -1,7 +1,11 @@
 #pragma once
 
+#ifdef _WIN32
 #ifdef IO_ADAPTER_EXPORTS
 #define IO_ADAPTER_API __declspec(dllexport)
 #else
 #define IO_ADAPTER_API __declspec(dllimport)
+#endif
+#else
+#define IO_ADAPTER_API __attribute__((visibility("default")))
 #endif
\ No newline at end of file
@@ -10,6 +10,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+
 #include <boost/signals2.hpp>
 
 namespace io
@@ -57,6 +60,29 @@ namespace io
             Unknown = -1
         };
 
+        enum class Edge
+        {
+            Rising,
+            Falling
+        };
+
+        // Conditioned (debounced) transition of an input pin
+        struct InputEvent
+        {
+            Gpio gpio;
+            Edge edge;
+            std::chrono::steady_clock::time_point timestamp;// Time of the first raw transition of the edge
+            uint16_t pinsState;                             // Conditioned state of all the pins after the edge
+            uint32_t count;                                 // Number of edges reported for this pin
+        };
+
+        // 8 bits GPIO ports (bit n of a port byte maps to pin Dn / Cn)
+        enum class Port
+        {
+            D = 0,// D0:D7 (Low byte)
+            C = 1 // C0:C7 (High byte)
+        };
+
 
         virtual ~inOut() = default;
 
@@ -88,15 +114,45 @@ namespace io
          */
         virtual bool get(Gpio gpio, GpioState& state) = 0;
 
+        /**
+         * @brief Configures the mode of several pins of the same port at once.
+         *
+         * @param port The GPIO port.
+         * @param mask The pins to configure (bit n --> pin n of the port).
+         * @param mode The mode to set.
+         * @return True if successful, false otherwise.
+         */
+        virtual bool pinsMode(Port port, uint8_t mask, PinMode mode) = 0;
+
+        /**
+         * @brief Set the output value of several pins of the same port at once.
+         *
+         * @param port The GPIO port.
+         * @param value The port value (bit n --> pin n of the port).
+         * @param mask The pins to update, the other pins keep their current value.
+         * @return True if successful, false otherwise.
+         */
+        virtual bool writePort(Port port, uint8_t value, uint8_t mask = 0xFF) = 0;
+
+        /**
+         * @brief Get the value of all the pins of a port.
+         *
+         * @param port The GPIO port.
+         * @param value Reference to store the retrieved port value.
+         * @return True if successful, false otherwise.
+         */
+        virtual bool readPort(Port port, uint8_t& value) = 0;
+
 
         /**
          * @brief Retrieves the state of the pins.
          *
-         * @param pinsState Reference to a uint16_t variable where the state of the pins will be stored.
+         * @param pinsState Reference to a uint16_t variable where the state of the pins will be stored
+         *                  (D0:D7 low byte, C0:C7 high byte), both ports are sampled at the same time.
          *
          * @return True if the pins state was successfully retrieved, false otherwise.
          */
-        //virtual bool getPinsState(uint16_t& pinsState) const = 0;
+        virtual bool getPinsState(uint16_t& pinsState) = 0;
 
         /**
         * @brief In Observers
@@ -104,6 +160,12 @@ namespace io
         */
         boost::signals2::signal<void(uint16_t /* value */)> valueChanged;
 
+        /**
+        * @brief Input edges observers (one call per conditioned edge)
+        * @note For RAII pattern see boost::signals2::scoped_connection
+        */
+        boost::signals2::signal<void(const InputEvent& /* event */)> edgeDetected;
+
     };
 
 } // namespace io
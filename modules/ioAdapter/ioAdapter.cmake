@@ -31,6 +31,39 @@ message("ftd2xx libs: "  ${EXTERNAL_LIBS}/ftdi-mpsse/official/release/libftd2xx)
 
 set(Boost_LIBRARY_DIR $ENV{BOOST_LIBRARYDIR})
 
+if(WIN32)
+	# Physical adapters: libMPSSE / libftd2xx (FtdiTransport)
+	set(IO_ADAPTER_DEPENDENCIES
+		${ft232_mpsse_Lib}/libmpsse.lib
+		${ft232_mpsse_Lib}/ftd2xx.lib
+		${Boost_LIBRARY_DIR}/libboost_thread-vc142-mt$<$<CONFIG:debug>:-gd>-x32-1_71.lib
+		${Boost_LIBRARY_DIR}/libboost_chrono-vc142-mt$<$<CONFIG:debug>:-gd>-x32-1_71.lib
+		${Boost_LIBRARY_DIR}/libboost_date_time-vc142-mt$<$<CONFIG:debug>:-gd>-x32-1_71.lib
+		${Boost_LIBRARY_DIR}/libboost_regex-vc142-mt$<$<CONFIG:debug>:-gd>-x32-1_71.lib
+		#debug ${libusbk_debug}/libusbK.lib
+		#${ft232Lib}/i386/ftd2xx.lib
+		#optimized ${libusbk_release}/libusbK.lib
+	)
+	set(IO_ADAPTER_POSTBUILD_COPY
+		${ft232_mpsse_Lib}/libmpsse.dll
+		${ft232_mpsse_Lib}/ftd2xx.dll
+		#debug ${libusbk_debug}/libusbK.dll
+		#${ft232Lib}/i386/ftd2xx.dll
+		#optimized ${libusbk_release}/libusbK.dll
+	)
+else()
+	# No FTDI libraries: the default transport is the simulated FT232H
+	list(FILTER CPP_FILES EXCLUDE REGEX ".*/FtdiTransport\\.cpp$")
+	find_package(Boost REQUIRED COMPONENTS thread chrono)
+	find_package(Threads REQUIRED)
+	set(IO_ADAPTER_DEPENDENCIES
+		Boost::thread
+		Boost::chrono
+		Threads::Threads
+	)
+	set(IO_ADAPTER_POSTBUILD_COPY)
+endif()
+
 add_module(ioAdapter
       MODULE_TYPE
          dll 
@@ -48,23 +81,16 @@ add_module(ioAdapter
 		#${ft232Lib}
 		#${EXTERNAL_LIBS}/ftdi-mpsse/official/release/
       DEPENDENCIES
-		${ft232_mpsse_Lib}/libmpsse.lib
-		${ft232_mpsse_Lib}/ftd2xx.lib
-		${Boost_LIBRARY_DIR}/libboost_thread-vc142-mt$<$<CONFIG:debug>:-gd>-x32-1_71.lib
-		${Boost_LIBRARY_DIR}/libboost_chrono-vc142-mt$<$<CONFIG:debug>:-gd>-x32-1_71.lib
-		${Boost_LIBRARY_DIR}/libboost_date_time-vc142-mt$<$<CONFIG:debug>:-gd>-x32-1_71.lib
-		${Boost_LIBRARY_DIR}/libboost_regex-vc142-mt$<$<CONFIG:debug>:-gd>-x32-1_71.lib
-		#debug ${libusbk_debug}/libusbK.lib
-		#${ft232Lib}/i386/ftd2xx.lib
-        #optimized ${libusbk_release}/libusbK.lib
+		${IO_ADAPTER_DEPENDENCIES}
 	  POSTBUILD_COPY
-		${ft232_mpsse_Lib}/libmpsse.dll
-		${ft232_mpsse_Lib}/ftd2xx.dll
-		#debug ${libusbk_debug}/libusbK.dll
-		#${ft232Lib}/i386/ftd2xx.dll
-        #optimized ${libusbk_release}/libusbK.dll
+		${IO_ADAPTER_POSTBUILD_COPY}
 	  IMPORT_SUFFIX
 		
 	  MODULE_HELP
 		FALSE
-)
\ No newline at end of file
+)
+
+if(WIN32)
+	# FT232_MPSSE::defaultTransport() and the factory use FtdiTransport
+	target_compile_definitions(ioAdapter PUBLIC IO_ADAPTER_FTDI)
+endif()
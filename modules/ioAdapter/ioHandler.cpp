@@ -4,6 +4,29 @@
 
 using namespace ioAdapter;
 
+namespace
+{
+// Records the duration of an API call when leaving its scope
+class CallRecord
+{
+public:
+    explicit CallRecord(IoAdapter::OperationMetrics& metrics) :
+        _metrics(metrics), _start(std::chrono::steady_clock::now())
+    {
+    }
+    CallRecord(const CallRecord&) = delete;
+    CallRecord& operator=(const CallRecord&) = delete;
+    ~CallRecord() { _metrics.record(std::chrono::steady_clock::now() - _start, _success); }
+
+    void succeeded() { _success = true; }
+
+private:
+    IoAdapter::OperationMetrics& _metrics;
+    const std::chrono::steady_clock::time_point _start;
+    bool _success = false;
+};
+}
+
 ioHandler::ioHandler(std::shared_ptr<inOut> device) :
     _device(std::move(device))
 {
@@ -11,6 +34,10 @@ ioHandler::ioHandler(std::shared_ptr<inOut> device) :
     {
         valueChanged(state);
     });
+    _device->edgeDetected.connect([&](const auto& event)
+    {
+        edgeDetected(event);
+    });
 }
 
 ioHandler::~ioHandler()
@@ -20,6 +47,7 @@ ioHandler::~ioHandler()
 
 bool ioHandler::pinMode(const Gpio gpio, const PinMode mode)
 {
+    CallRecord record(_outputMetrics);
     const std::lock_guard<std::mutex> lock(_mutex);
 
     if (_device == nullptr)
@@ -34,11 +62,13 @@ bool ioHandler::pinMode(const Gpio gpio, const PinMode mode)
         return false;
     }
 
+    record.succeeded();
     return true;
 }
 
 bool ioHandler::set(const Gpio gpio, const GpioState state)
 {
+    CallRecord record(_outputMetrics);
     const std::lock_guard<std::mutex> lock(_mutex);
 
     if (_device == nullptr)
@@ -53,11 +83,13 @@ bool ioHandler::set(const Gpio gpio, const GpioState state)
         return false;
     }
 
+    record.succeeded();
     return true;
 }
 
 bool ioHandler::get(const Gpio gpio, GpioState& state)
 {
+    CallRecord record(_inputMetrics);
     const std::lock_guard<std::mutex> lock(_mutex);
 
     if (_device == nullptr)
@@ -72,5 +104,98 @@ bool ioHandler::get(const Gpio gpio, GpioState& state)
         return false;
     }
 
+    record.succeeded();
     return true;
 }
+
+bool ioHandler::pinsMode(const Port port, const uint8_t mask, const PinMode mode)
+{
+    CallRecord record(_outputMetrics);
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_device == nullptr)
+    {
+        std::cerr << "Error: Device pointer is null." << std::endl;
+        return false;
+    }
+
+    if (!_device->pinsMode(port, mask, mode))
+    {
+        std::cerr << "Error setting port pins mode." << std::endl;
+        return false;
+    }
+
+    record.succeeded();
+    return true;
+}
+
+bool ioHandler::writePort(const Port port, const uint8_t value, const uint8_t mask)
+{
+    CallRecord record(_outputMetrics);
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_device == nullptr)
+    {
+        std::cerr << "Error: Device pointer is null." << std::endl;
+        return false;
+    }
+
+    if (!_device->writePort(port, value, mask))
+    {
+        std::cerr << "Error setting port state." << std::endl;
+        return false;
+    }
+
+    record.succeeded();
+    return true;
+}
+
+bool ioHandler::readPort(const Port port, uint8_t& value)
+{
+    CallRecord record(_inputMetrics);
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_device == nullptr)
+    {
+        std::cerr << "Error: Device pointer is null." << std::endl;
+        return false;
+    }
+
+    if (!_device->readPort(port, value))
+    {
+        std::cerr << "Error getting port state." << std::endl;
+        return false;
+    }
+
+    record.succeeded();
+    return true;
+}
+
+bool ioHandler::getPinsState(uint16_t& pinsState)
+{
+    CallRecord record(_inputMetrics);
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_device == nullptr)
+    {
+        std::cerr << "Error: Device pointer is null." << std::endl;
+        return false;
+    }
+
+    if (!_device->getPinsState(pinsState))
+    {
+        std::cerr << "Error getting pins state." << std::endl;
+        return false;
+    }
+
+    record.succeeded();
+    return true;
+}
+
+ioHandler::MetricsSnapshot ioHandler::metrics() const
+{
+    MetricsSnapshot snapshot;
+    snapshot.outputs = _outputMetrics.snapshot();
+    snapshot.inputs = _inputMetrics.snapshot();
+    return snapshot;
+}
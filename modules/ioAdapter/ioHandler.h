@@ -2,6 +2,7 @@
 
 #include <memory>
 
+#include "Metrics.h"
 #include "inout.h"
 #include "export.h"
 
@@ -24,9 +25,31 @@ namespace ioAdapter
         bool pinMode(Gpio gpio, PinMode mode) override;
         bool set(Gpio gpio, GpioState state) override;
         bool get(Gpio gpio, GpioState& state) override;
+        bool pinsMode(Port port, uint8_t mask, PinMode mode) override;
+        bool writePort(Port port, uint8_t value, uint8_t mask = 0xFF) override;
+        bool readPort(Port port, uint8_t& value) override;
+        bool getPinsState(uint16_t& pinsState) override;
+
+        /**
+         * @brief Latency (lock wait included) & counters of the API calls.
+         */
+        struct MetricsSnapshot
+        {
+            IoAdapter::OperationSnapshot outputs;   // pinMode, set, pinsMode, writePort
+            IoAdapter::OperationSnapshot inputs;    // get, readPort, getPinsState
+        };
+
+        /**
+         * @brief Get the handler metrics, can be called at any time without stopping the I/O.
+         *
+         * @return The latencies & counters since the construction.
+         */
+        MetricsSnapshot metrics() const;
 
     private:
         std::shared_ptr<io::inOut> _device;
         std::mutex _mutex;
+        IoAdapter::OperationMetrics _outputMetrics;
+        IoAdapter::OperationMetrics _inputMetrics;
     };
 }
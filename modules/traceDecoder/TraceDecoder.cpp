@@ -0,0 +1,320 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+*/
+
+#include "TraceDecoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include "Ft232Transport.h"
+
+using namespace TraceDecoder;
+using IoAdapter::Ft232Transport;
+using IoAdapter::TraceFileHeader;
+using IoAdapter::TraceKind;
+using IoAdapter::TraceRecord;
+
+static std::string hex(const uint32_t value, const int width = 2)
+{
+    std::ostringstream text;
+    text << "0x" << std::hex << std::setw(width) << std::setfill('0') << value;
+    return text.str();
+}
+
+static std::string bytes(const uint8_t* data, const size_t size)
+{
+    std::ostringstream text;
+    for (size_t index = 0; index < size; ++index)
+    {
+        text << (index > 0 ? " " : "") << std::hex << std::setw(2) << std::setfill('0') << static_cast<unsigned>(data[index]);
+    }
+    return text.str();
+}
+
+static std::string statusName(const uint32_t status)
+{
+    switch (status)
+    {
+    case Ft232Transport::Ok: return "Ok";
+    case Ft232Transport::InvalidHandle: return "InvalidHandle";
+    case Ft232Transport::DeviceNotFound: return "DeviceNotFound";
+    case Ft232Transport::DeviceNotOpened: return "DeviceNotOpened";
+    case Ft232Transport::IoError: return "IoError";
+    case Ft232Transport::InvalidParameter: return "InvalidParameter";
+    default: return "Status(" + std::to_string(status) + ")";
+    }
+}
+
+static std::string transferOptions(const uint32_t options)
+{
+    static const std::pair<uint32_t, const char*> names[] = {
+        { Ft232Transport::TransferStartBit, "START" },
+        { Ft232Transport::TransferStopBit, "STOP" },
+        { Ft232Transport::TransferBreakOnNack, "BREAK_ON_NACK" },
+        { Ft232Transport::TransferNackLastByte, "NACK_LAST" },
+        { Ft232Transport::TransferFastBytes, "FAST_BYTES" },
+        { Ft232Transport::TransferFastBits, "FAST_BITS" },
+        { Ft232Transport::TransferNoAddress, "NO_ADDRESS" }
+    };
+
+    std::string text;
+    for (const auto& [bit, name] : names)
+    {
+        if (options & bit)
+        {
+            text += (text.empty() ? "" : " ") + std::string(name);
+        }
+    }
+    return "[" + text + "]";
+}
+
+bool Decoder::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Can't open " << path << std::endl;
+        return false;
+    }
+    _file.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (_file.size() < sizeof(TraceFileHeader) ||
+        std::memcmp(header().magic, TraceFileHeader::Magic, sizeof(TraceFileHeader::Magic)) != 0)
+    {
+        std::cerr << path << " is not a trace ring file" << std::endl;
+        _file.clear();
+        return false;
+    }
+    if (header().version != TraceFileHeader::Version || header().recordSize != sizeof(TraceRecord) ||
+        _file.size() < sizeof(TraceFileHeader) + header().capacity * sizeof(TraceRecord))
+    {
+        std::cerr << path << ": unsupported version or truncated file" << std::endl;
+        _file.clear();
+        return false;
+    }
+    return true;
+}
+
+const TraceFileHeader& Decoder::header() const
+{
+    return *reinterpret_cast<const TraceFileHeader*>(_file.data());
+}
+
+const TraceRecord& Decoder::slot(const uint64_t sequence) const
+{
+    const auto offset = sizeof(TraceFileHeader) + (sequence % header().capacity) * sizeof(TraceRecord);
+    return *reinterpret_cast<const TraceRecord*>(_file.data() + offset);
+}
+
+size_t Decoder::print(std::ostream& out, const uint64_t last) const
+{
+    if (_file.empty())
+        return 0;
+
+    const auto head = header().head.load();
+    auto first = head > header().capacity ? head - header().capacity : 0;
+    if (last > 0 && head - first > last)
+    {
+        first = head - last;
+    }
+
+    const auto start = static_cast<std::time_t>(header().startTime / 1000000000);
+    out << "Trace started " << std::put_time(std::gmtime(&start), "%Y-%m-%d %H:%M:%S UTC") << ", "
+        << head << " records (" << std::min<uint64_t>(head, header().capacity) << " kept)" << std::endl;
+
+    size_t printed = 0;
+    uint64_t skipped = 0;
+    for (auto sequence = first; sequence < head; ++sequence)
+    {
+        const auto& record = slot(sequence);
+        if (record.sequence.load() != sequence + 1)
+        {
+            // Overwritten or being written when the file was read
+            skipped++;
+            continue;
+        }
+
+        out << "+" << std::fixed << std::setprecision(6) << static_cast<double>(record.timestamp) / 1e9
+            << " [" << std::hex << std::setw(8) << std::setfill('0') << record.thread << std::dec << std::setfill(' ')
+            << "] " << describe(record) << std::endl;
+        printed++;
+    }
+    if (skipped > 0)
+    {
+        out << skipped << " records skipped (overwritten or in progress)" << std::endl;
+    }
+    return printed;
+}
+
+std::string Decoder::describe(const TraceRecord& record)
+{
+    std::ostringstream text;
+    const auto count = std::to_string(record.transferred) + "/" + std::to_string(record.size) +
+                       ((record.options & Ft232Transport::TransferFastBits) ? " bits" : "");
+    auto expected = record.kind == TraceKind::Read || record.kind == TraceKind::DeviceRead ? record.transferred : record.size;
+    if ((record.kind == TraceKind::DeviceWrite || record.kind == TraceKind::DeviceRead) &&
+        (record.options & Ft232Transport::TransferFastBits))
+    {
+        expected = (expected + 7) / 8;
+    }
+    const auto truncated = record.dataSize < expected;
+
+    switch (record.kind)
+    {
+    case TraceKind::Write:
+        text << "FT_Write  " << count << " " << statusName(record.status) << "  "
+             << decodeCommands(record.data, record.dataSize);
+        break;
+    case TraceKind::Read:
+        text << "FT_Read   " << count << " " << statusName(record.status) << "  " << bytes(record.data, record.dataSize);
+        if (record.dataSize >= 2 && record.data[0] == 0xFA)
+        {
+            text << " (BAD_COMMAND " << hex(record.data[1]) << ")";
+        }
+        break;
+    case TraceKind::DeviceWrite:
+    case TraceKind::DeviceRead:
+        text << (record.kind == TraceKind::DeviceWrite ? "I2C_Write " : "I2C_Read  ") << hex(record.address) << " "
+             << count << " " << statusName(record.status) << " " << transferOptions(record.options) << " "
+             << bytes(record.data, record.dataSize);
+        break;
+    case TraceKind::Open:
+        text << "Open      " << statusName(record.status) << "  ";
+        if (record.address == 0)
+        {
+            text << "channel " << record.size;
+        }
+        else if (record.address - 1 == static_cast<int>(Ft232Transport::OpenBy::Location))
+        {
+            text << "location " << hex(record.options, 4);
+        }
+        else
+        {
+            text << (record.address - 1 == static_cast<int>(Ft232Transport::OpenBy::SerialNumber) ? "serial " : "description ")
+                 << "\"" << std::string(reinterpret_cast<const char*>(record.data), record.dataSize) << "\"";
+        }
+        break;
+    case TraceKind::Init:
+        text << "Init      " << statusName(record.status) << "  clock " << record.size << " Hz, latency "
+             << static_cast<unsigned>(record.address) << " ms, options " << hex(record.options) << ", pin "
+             << hex(record.transferred, 8);
+        break;
+    case TraceKind::Close:
+        text << "Close     " << statusName(record.status);
+        break;
+    default:
+        text << "Unknown record " << static_cast<unsigned>(record.kind);
+        break;
+    }
+
+    if (truncated && record.kind != TraceKind::Open && record.kind != TraceKind::Init && record.kind != TraceKind::Close)
+    {
+        text << " ...";
+    }
+    return text.str();
+}
+
+/*
+   The GPIO & clock commands used by FT232_MPSSE are named with their parameters, the data shifting
+   commands (0x10:0x3F, used by libMPSSE for the I2C) with their length.
+ */
+std::string Decoder::decodeCommands(const uint8_t* data, const size_t size)
+{
+    std::ostringstream text;
+    size_t index = 0;
+
+    // Parameters of the current command, false if the payload is cut
+    auto has = [&](const size_t count) { return index + count < size; };
+
+    while (index < size)
+    {
+        if (index > 0)
+        {
+            text << " | ";
+        }
+
+        const auto opcode = data[index];
+        switch (opcode)
+        {
+        case 0x80:
+        case 0x82:
+            if (!has(2))
+                break;
+            text << (opcode == 0x80 ? "SET_D" : "SET_C") << " value=" << hex(data[index + 1]) << " dir=" << hex(data[index + 2]);
+            index += 3;
+            continue;
+        case 0x81: text << "GET_D"; index++; continue;
+        case 0x83: text << "GET_C"; index++; continue;
+        case 0x84: text << "LOOPBACK_ON"; index++; continue;
+        case 0x85: text << "LOOPBACK_OFF"; index++; continue;
+        case 0x87: text << "SEND_IMMEDIATE"; index++; continue;
+        case 0x88: text << "WAIT_IO_HIGH"; index++; continue;
+        case 0x89: text << "WAIT_IO_LOW"; index++; continue;
+        case 0x8A: text << "DIV5_OFF"; index++; continue;
+        case 0x8B: text << "DIV5_ON"; index++; continue;
+        case 0x8C: text << "3PHASE_ON"; index++; continue;
+        case 0x8D: text << "3PHASE_OFF"; index++; continue;
+        case 0x96: text << "ADAPTIVE_ON"; index++; continue;
+        case 0x97: text << "ADAPTIVE_OFF"; index++; continue;
+        case 0x8E:
+            if (!has(1))
+                break;
+            text << "CLOCK_BITS " << (data[index + 1] + 1);
+            index += 2;
+            continue;
+        case 0x86:
+        case 0x8F:
+        case 0x9E:
+        {
+            if (!has(2))
+                break;
+            const auto value = static_cast<uint32_t>(data[index + 1]) | static_cast<uint32_t>(data[index + 2] << 8);
+            if (opcode == 0x86)
+                text << "DIVISOR " << value;
+            else if (opcode == 0x8F)
+                text << "CLOCK_BYTES " << (value + 1);
+            else
+                text << "DRIVE_ZERO D=" << hex(data[index + 1]) << " C=" << hex(data[index + 2]);
+            index += 3;
+            continue;
+        }
+        default:
+            if (opcode >= 0x10 && opcode <= 0x3F)
+            {
+                // Bit 1: bit mode, bit 4: data out, bit 5: data in
+                const bool bitMode = opcode & 0x02;
+                const bool out = opcode & 0x10;
+                if (!has(bitMode ? 1 : 2))
+                    break;
+                const uint32_t length = bitMode ? data[index + 1] + 1u
+                                                : (data[index + 1] | static_cast<uint32_t>(data[index + 2] << 8)) + 1u;
+                index += bitMode ? 2 : 3;
+                text << "SHIFT_" << (out ? ((opcode & 0x20) ? "INOUT " : "OUT ") : "IN ") << length
+                     << (bitMode ? " bits" : " bytes");
+                if (out)
+                {
+                    const size_t payload = bitMode ? 1 : length;
+                    const auto available = std::min(payload, size - index);
+                    text << " [" << bytes(data + index, available) << "]";
+                    index += available;
+                }
+                continue;
+            }
+            break;
+        }
+
+        // Unknown opcode or cut parameters: the rest is dumped
+        text << "?? " << bytes(data + index, size - index);
+        break;
+    }
+    return text.str();
+}
@@ -0,0 +1,80 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Decoder of the FT232H trace ring files (see TraceRing.h): the published records are listed oldest
+    first, the MPSSE commands of the USB writes and the I2C transactions are turned into text.
+
+    Exemple:
+    +0.001250 [3fa2c1d0] FT_Write  6/6 Ok      SET_C value=0x01 dir=0xfb | GET_C | SEND_IMMEDIATE
+    +0.001510 [3fa2c1d0] FT_Read   1/1 Ok      01
+    +0.002040 [3fa2c1d0] I2C_Write 0x40 3/3 Ok [START STOP] 06 23 01
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "TraceRing.h"
+
+namespace TraceDecoder
+{
+    class Decoder final
+    {
+    public:
+        Decoder() = default;
+        // Delete the default copy constructor
+        Decoder(const Decoder&) = delete;
+        Decoder& operator=(const Decoder&) = delete;
+        // Delete the default move constructor
+        Decoder(Decoder&&) = delete;
+        Decoder& operator=(Decoder&&) = delete;
+        ~Decoder() = default;
+
+        /**
+         * @brief Load a ring file (it can still be written by a running process).
+         *
+         * @param path The ring file.
+         * @return True if successful, false if the file is missing or isn't a trace ring.
+         */
+        bool load(const std::string& path);
+
+        /**
+         * @brief Print the records, oldest first.
+         *
+         * @param out The output stream.
+         * @param last The number of most recent records printed, 0 for all.
+         * @return The number of printed records.
+         */
+        size_t print(std::ostream& out, uint64_t last = 0) const;
+
+        /**
+         * @brief Decode MPSSE commands (FT_Write payload).
+         *
+         * @param data The commands.
+         * @param size The number of bytes.
+         * @return The commands separated by " | ".
+         */
+        static std::string decodeCommands(const uint8_t* data, size_t size);
+
+        /**
+         * @brief Describe a record on one line.
+         *
+         * @param record The record.
+         * @return The text, without the timestamp and thread.
+         */
+        static std::string describe(const IoAdapter::TraceRecord& record);
+
+    private:
+        const IoAdapter::TraceFileHeader& header() const;
+        const IoAdapter::TraceRecord& slot(uint64_t sequence) const;
+
+        std::vector<uint8_t> _file;
+    };
+}
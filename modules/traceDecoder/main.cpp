@@ -0,0 +1,49 @@
+/*
+    Copyright (c) 2024 - FutureIsTech
+    Author: Omar Terro
+    All rights reserved
+
+    Description:
+    Print an FT232H trace ring file (see TracingTransport.h) as readable MPSSE / I2C traffic.
+
+    Usage: traceDecoder <trace file> [--last N]
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "TraceDecoder.h"
+
+int main(const int argc, char* argv[])
+{
+    std::string path;
+    uint64_t last = 0;
+
+    for (int arg = 1; arg < argc; ++arg)
+    {
+        const std::string option = argv[arg];
+        if (option == "--last" && arg + 1 < argc)
+            last = std::strtoull(argv[++arg], nullptr, 10);
+        else if (path.empty() && option.rfind("--", 0) != 0)
+            path = option;
+        else
+        {
+            path.clear();
+            break;
+        }
+    }
+
+    if (path.empty())
+    {
+        std::cerr << "Usage: traceDecoder <trace file> [--last N]" << std::endl;
+        return 2;
+    }
+
+    TraceDecoder::Decoder decoder;
+    if (!decoder.load(path))
+        return 1;
+
+    decoder.print(std::cout, last);
+    return 0;
+}